@@ -0,0 +1,91 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+    Vectorized primitives used by the forward and backward passes of all the networks.
+
+    Every kernel has a scalar, an SSE2, an AVX2 and an AVX-512 version. The best version supported by
+    the CPU is picked on first use. Setting the environment variable KERNELS_LEVEL to scalar, sse2,
+    avx2 or avx512 lowers the level at startup; force_level() does the same from code.
+
+    The vectorized versions accumulate in a different order than the scalar ones, so the results
+    may differ in the last bits.
+
+    The activations come in three accuracy tiers: exact (the C library), polynomial (errors around
+    1e-14) and table (linear interpolation). In the table tier exp has relative errors below 1e-6,
+    but tanh and sigmoid have absolute errors below 2e-6 and 1e-6, and their inputs are clamped to
+    [-8, 8] and [-16, 16]. So sigmoid(-20) gives sigmoid(-16), about 1.1e-7 instead of 2e-9, and the
+    table tier is unsuitable where small probabilities matter. The tier is exact by default;
+    KERNELS_ACCURACY set to exact, polynomial or table changes it at startup and set_accuracy() does
+    the same from code. The kernels_report program measures every tier against the C library.
+*/
+
+namespace kernels {
+    enum class Level {
+        Scalar,
+        Sse2,
+        Avx2,
+        Avx512
+    };
+
+    enum class Accuracy {
+        Exact,
+        Polynomial,
+        Table
+    };
+
+    // Best level supported by this CPU
+    Level detect_level();
+
+    // Level currently used by all the kernels
+    Level get_level();
+
+    // Return false and change nothing, if the CPU does not support the level
+    bool force_level(Level level);
+
+    const char* get_level_name(Level level);
+
+    Accuracy get_accuracy();
+    void set_accuracy(Accuracy accuracy);
+    const char* get_accuracy_name(Accuracy accuracy);
+
+    // Sum of a[i] * b[i]
+    double dot(const double* a, const double* b, std::size_t size);
+    float dot(const float* a, const float* b, std::size_t size);
+
+    // Exact in 32 bits for up to 133'000 elements
+    std::int32_t dot(const std::int8_t* a, const std::int8_t* b, std::size_t size);
+
+    // Product of a[i] * b[i]; 1.0 for no elements
+    double product(const double* a, const double* b, std::size_t size);
+
+    // Maximum and minimum of a[i] * b[i]; -infinity and +infinity respectively for no elements
+    double max(const double* a, const double* b, std::size_t size);
+    double min(const double* a, const double* b, std::size_t size);
+
+    // y[i] += alpha * x[i]
+    void axpy(double alpha, const double* x, double* y, std::size_t size);
+    void axpy(float alpha, const float* x, float* y, std::size_t size);
+
+    // c = a * b^T, where a is m x k, b is n x k and c is m x n, all row major with row strides in elements
+    void gemm(std::size_t m, std::size_t n, std::size_t k, const double* a, std::size_t a_stride, const double* b, std::size_t b_stride, double* c, std::size_t c_stride);
+    void gemm(std::size_t m, std::size_t n, std::size_t k, const float* a, std::size_t a_stride, const float* b, std::size_t b_stride, float* c, std::size_t c_stride);
+
+    // x[i] = f(x[i]) with the current accuracy
+    void exp(double* x, std::size_t size);
+    void tanh(double* x, std::size_t size);
+    void sigmoid(double* x, std::size_t size);
+    void exp(float* x, std::size_t size);
+    void tanh(float* x, std::size_t size);
+    void sigmoid(float* x, std::size_t size);
+
+    // x[i] = f(x[i]) with a specific accuracy; the float approximations are evaluated in double
+    void exp(double* x, std::size_t size, Accuracy accuracy);
+    void tanh(double* x, std::size_t size, Accuracy accuracy);
+    void sigmoid(double* x, std::size_t size, Accuracy accuracy);
+    void exp(float* x, std::size_t size, Accuracy accuracy);
+    void tanh(float* x, std::size_t size, Accuracy accuracy);
+    void sigmoid(float* x, std::size_t size, Accuracy accuracy);
+}
@@ -0,0 +1,166 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <array>
+#include <bit>
+#include <algorithm>
+
+/*
+    Element-wise implementations of the activations, written without branches and library calls
+    (except for the exact ones), so that the loops calling them vectorize. They are inlined into the
+    functions of every instruction set, which compile them for that specific extension.
+*/
+
+namespace kernels::activations {
+    inline constexpr double LOG2E = 1.4426950408889634;
+    inline constexpr double LN2_HIGH = 0.6931471803691238;  // High bits of ln(2); n * LN2_HIGH is exact
+    inline constexpr double LN2_LOW = 1.9082149292705877e-10;
+    inline constexpr double ROUND = 6755399441055744.0;  // 1.5 * 2^52; adding it rounds to an integer
+    inline constexpr double EXP_MIN = -708.0;
+    inline constexpr double EXP_MAX = 709.0;
+
+    // Selects instead of std::clamp, which returns a reference and keeps the loops from vectorizing
+    inline double clamp(double x, double low, double high) {
+        x = x < low ? low : x;
+        x = x > high ? high : x;
+
+        return x;
+    }
+
+    // 2^n, for an integer n from x + ROUND
+    inline double power_of_two(double rounded) {
+        return std::bit_cast<double>((std::bit_cast<std::uint64_t>(rounded) + 1023u) << 52);
+    }
+
+    inline double exp_exact(double x) {
+        return std::exp(x);
+    }
+
+    inline double tanh_exact(double x) {
+        return std::tanh(x);
+    }
+
+    inline double sigmoid_exact(double x) {
+        return 1.0 / (1.0 + std::exp(-x));
+    }
+
+    // Relative error below 1e-14 in [EXP_MIN, EXP_MAX]; inputs outside of it are clamped
+    inline double exp_polynomial(double x) {
+        x = clamp(x, EXP_MIN, EXP_MAX);
+
+        const double rounded = x * LOG2E + ROUND;
+        const double n = rounded - ROUND;
+        const double r = (x - n * LN2_HIGH) - n * LN2_LOW;  // |r| <= ln(2) / 2
+
+        // Taylor series of degree 11
+        double p = 1.0 / 39916800.0;
+        p = p * r + 1.0 / 3628800.0;
+        p = p * r + 1.0 / 362880.0;
+        p = p * r + 1.0 / 40320.0;
+        p = p * r + 1.0 / 5040.0;
+        p = p * r + 1.0 / 720.0;
+        p = p * r + 1.0 / 120.0;
+        p = p * r + 1.0 / 24.0;
+        p = p * r + 1.0 / 6.0;
+        p = p * r + 0.5;
+        p = p * r + 1.0;
+        p = p * r + 1.0;
+
+        return p * power_of_two(rounded);
+    }
+
+    inline double tanh_polynomial(double x) {
+        const double a = std::fabs(x);
+        const double e = exp_polynomial(-2.0 * a);
+        const double large = (1.0 - e) / (1.0 + e);
+
+        // Near zero 1 - e cancels, so use the series there
+        const double x2 = x * x;
+        const double small = a * (1.0 + x2 * (-1.0 / 3.0 + x2 * (2.0 / 15.0 + x2 * (-17.0 / 315.0))));
+
+        return std::copysign(a < 0.03 ? small : large, x);
+    }
+
+    inline double sigmoid_polynomial(double x) {
+        return 1.0 / (1.0 + exp_polynomial(-x));
+    }
+
+    /*
+        Tables with linear interpolation between the entries. exp uses 2^(j / N) for the fraction of
+        the power of two. tanh and sigmoid are sampled directly and saturate outside of their ranges.
+    */
+
+    inline constexpr std::size_t EXP_TABLE_SIZE = 256;
+    inline constexpr std::size_t TABLE_SIZE = 4096;
+    inline constexpr double TANH_RANGE = 8.0;
+    inline constexpr double SIGMOID_RANGE = 16.0;
+
+    struct Tables {
+        std::array<double, EXP_TABLE_SIZE + 1> exp2 {};
+        std::array<double, TABLE_SIZE + 1> tanh {};
+        std::array<double, TABLE_SIZE + 1> sigmoid {};
+    };
+
+    inline Tables build_tables() {
+        Tables tables;
+
+        for (std::size_t i = 0; i <= EXP_TABLE_SIZE; i++) {
+            tables.exp2[i] = std::exp2(static_cast<double>(i) / static_cast<double>(EXP_TABLE_SIZE));
+        }
+
+        for (std::size_t i = 0; i <= TABLE_SIZE; i++) {
+            const double t = static_cast<double>(i) / static_cast<double>(TABLE_SIZE) * 2.0 - 1.0;
+
+            tables.tanh[i] = std::tanh(t * TANH_RANGE);
+            tables.sigmoid[i] = 1.0 / (1.0 + std::exp(-t * SIGMOID_RANGE));
+        }
+
+        return tables;
+    }
+
+    inline const Tables tables = build_tables();
+
+    inline double interpolate(const double* table, std::size_t size, double position) {
+        // Position is in [0, size]
+        const std::size_t index = std::min(static_cast<std::size_t>(position), size - 1);
+        const double fraction = position - static_cast<double>(index);
+
+        return table[index] + (table[index + 1] - table[index]) * fraction;
+    }
+
+    // Relative error below 1e-6 in [EXP_MIN, EXP_MAX]
+    inline double exp_table(double x) {
+        x = clamp(x, EXP_MIN, EXP_MAX);
+
+        const double y = x * LOG2E;
+        double rounded = y + ROUND;
+        double n = rounded - ROUND;
+
+        // Make the fraction positive
+        const double below = n > y ? 1.0 : 0.0;
+        rounded -= below;
+        n -= below;
+
+        const double fraction = y - n;
+
+        return interpolate(tables.exp2.data(), EXP_TABLE_SIZE, fraction * EXP_TABLE_SIZE) * power_of_two(rounded);
+    }
+
+    // Absolute error below 2e-6; saturates at tanh(8) = 1 - 2.3e-7
+    inline double tanh_table(double x) {
+        const double t = clamp(x, -TANH_RANGE, TANH_RANGE);
+        const double position = (t / TANH_RANGE + 1.0) * 0.5 * TABLE_SIZE;
+
+        return interpolate(tables.tanh.data(), TABLE_SIZE, position);
+    }
+
+    // Absolute error below 1e-6; saturates at sigmoid(-16) = 1.1e-7, far from small probabilities
+    inline double sigmoid_table(double x) {
+        const double t = clamp(x, -SIGMOID_RANGE, SIGMOID_RANGE);
+        const double position = (t / SIGMOID_RANGE + 1.0) * 0.5 * TABLE_SIZE;
+
+        return interpolate(tables.sigmoid.data(), TABLE_SIZE, position);
+    }
+}
@@ -0,0 +1,337 @@
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include "table.hpp"
+#include "activations.hpp"
+#include "gemm.hpp"
+
+#ifdef KERNELS_X86
+
+#include <immintrin.h>
+
+#define TARGET KERNELS_TARGET("avx2,fma")
+
+namespace kernels {
+    TARGET static double horizontal_add(__m256d x) {
+        __m128d half = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+
+        return _mm_cvtsd_f64(_mm_add_sd(half, _mm_unpackhi_pd(half, half)));
+    }
+
+    TARGET static float horizontal_add(__m256 x) {
+        __m128 half = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+        half = _mm_add_ps(half, _mm_movehl_ps(half, half));
+        half = _mm_add_ss(half, _mm_shuffle_ps(half, half, 0x1));
+
+        return _mm_cvtss_f32(half);
+    }
+
+    TARGET static double dot_f64(const double* a, const double* b, std::size_t size) {
+        __m256d sum0 = _mm256_setzero_pd();
+        __m256d sum1 = _mm256_setzero_pd();
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+            sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), sum1);
+        }
+
+        for (; i + 4 <= size; i += 4) {
+            sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+        }
+
+        double result = horizontal_add(_mm256_add_pd(sum0, sum1));
+
+        for (; i < size; i++) {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    TARGET static float dot_f32(const float* a, const float* b, std::size_t size) {
+        __m256 sum0 = _mm256_setzero_ps();
+        __m256 sum1 = _mm256_setzero_ps();
+
+        std::size_t i = 0;
+
+        for (; i + 16 <= size; i += 16) {
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+            sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i + 8), _mm256_loadu_ps(b + i + 8), sum1);
+        }
+
+        for (; i + 8 <= size; i += 8) {
+            sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), sum0);
+        }
+
+        float result = horizontal_add(_mm256_add_ps(sum0, sum1));
+
+        for (; i < size; i++) {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    TARGET static std::int32_t horizontal_add(__m256i x) {
+        __m128i half = _mm_add_epi32(_mm256_castsi256_si128(x), _mm256_extracti128_si256(x, 1));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0x4e));
+        half = _mm_add_epi32(half, _mm_shuffle_epi32(half, 0xb1));
+
+        return _mm_cvtsi128_si32(half);
+    }
+
+    TARGET static std::int32_t dot_i8(const std::int8_t* a, const std::int8_t* b, std::size_t size) {
+        __m256i sum0 = _mm256_setzero_si256();
+        __m256i sum1 = _mm256_setzero_si256();
+
+        std::size_t i = 0;
+
+        // Sign extend 16 bytes at a time to 16 bit lanes; madd sums adjacent products into 32 bits
+        for (; i + 32 <= size; i += 32) {
+            const __m256i x0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+            const __m256i y0 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+            const __m256i x1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i + 16)));
+            const __m256i y1 = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i + 16)));
+
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(x0, y0));
+            sum1 = _mm256_add_epi32(sum1, _mm256_madd_epi16(x1, y1));
+        }
+
+        for (; i + 16 <= size; i += 16) {
+            const __m256i x = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+            const __m256i y = _mm256_cvtepi8_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+
+            sum0 = _mm256_add_epi32(sum0, _mm256_madd_epi16(x, y));
+        }
+
+        std::int32_t result = horizontal_add(_mm256_add_epi32(sum0, sum1));
+
+        for (; i < size; i++) {
+            result += static_cast<std::int32_t>(a[i]) * static_cast<std::int32_t>(b[i]);
+        }
+
+        return result;
+    }
+
+    TARGET static double product_f64(const double* a, const double* b, std::size_t size) {
+        __m256d accumulator = _mm256_set1_pd(1.0);
+
+        std::size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            accumulator = _mm256_mul_pd(accumulator, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        }
+
+        __m128d half = _mm_mul_pd(_mm256_castpd256_pd128(accumulator), _mm256_extractf128_pd(accumulator, 1));
+        double result = _mm_cvtsd_f64(_mm_mul_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; i < size; i++) {
+            result *= a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    TARGET static double max_f64(const double* a, const double* b, std::size_t size) {
+        __m256d accumulator = _mm256_set1_pd(-std::numeric_limits<double>::infinity());
+
+        std::size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            accumulator = _mm256_max_pd(accumulator, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        }
+
+        __m128d half = _mm_max_pd(_mm256_castpd256_pd128(accumulator), _mm256_extractf128_pd(accumulator, 1));
+        double result = _mm_cvtsd_f64(_mm_max_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; i < size; i++) {
+            result = std::max(result, a[i] * b[i]);
+        }
+
+        return result;
+    }
+
+    TARGET static double min_f64(const double* a, const double* b, std::size_t size) {
+        __m256d accumulator = _mm256_set1_pd(std::numeric_limits<double>::infinity());
+
+        std::size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            accumulator = _mm256_min_pd(accumulator, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        }
+
+        __m128d half = _mm_min_pd(_mm256_castpd256_pd128(accumulator), _mm256_extractf128_pd(accumulator, 1));
+        double result = _mm_cvtsd_f64(_mm_min_sd(half, _mm_unpackhi_pd(half, half)));
+
+        for (; i < size; i++) {
+            result = std::min(result, a[i] * b[i]);
+        }
+
+        return result;
+    }
+
+    TARGET static void axpy_f64(double alpha, const double* x, double* y, std::size_t size) {
+        const __m256d factor = _mm256_set1_pd(alpha);
+
+        std::size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            _mm256_storeu_pd(y + i, _mm256_fmadd_pd(factor, _mm256_loadu_pd(x + i), _mm256_loadu_pd(y + i)));
+        }
+
+        for (; i < size; i++) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    TARGET static void axpy_f32(float alpha, const float* x, float* y, std::size_t size) {
+        const __m256 factor = _mm256_set1_ps(alpha);
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            _mm256_storeu_ps(y + i, _mm256_fmadd_ps(factor, _mm256_loadu_ps(x + i), _mm256_loadu_ps(y + i)));
+        }
+
+        for (; i < size; i++) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    TARGET static void exp_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void exp_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_table(x[i]);
+        }
+    }
+
+    TARGET static void tanh_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void tanh_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_table(x[i]);
+        }
+    }
+
+    TARGET static void sigmoid_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void sigmoid_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_table(x[i]);
+        }
+    }
+
+    // Tile of 6 x 8 doubles in 12 registers
+    TARGET static void gemm_kernel_f64(std::size_t kc, const double* a, const double* b, double* c, std::size_t c_stride, bool accumulate) {
+        __m256d sums[6][2];
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 6; i++) {
+            sums[i][0] = _mm256_setzero_pd();
+            sums[i][1] = _mm256_setzero_pd();
+        }
+
+        for (std::size_t p = 0; p < kc; p++) {
+            const __m256d b0 = _mm256_loadu_pd(b + p * 8);
+            const __m256d b1 = _mm256_loadu_pd(b + p * 8 + 4);
+
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < 6; i++) {
+                const __m256d x = _mm256_set1_pd(a[p * 6 + i]);
+                sums[i][0] = _mm256_fmadd_pd(x, b0, sums[i][0]);
+                sums[i][1] = _mm256_fmadd_pd(x, b1, sums[i][1]);
+            }
+        }
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 6; i++) {
+            double* row = c + i * c_stride;
+
+            if (accumulate) {
+                sums[i][0] = _mm256_add_pd(sums[i][0], _mm256_loadu_pd(row));
+                sums[i][1] = _mm256_add_pd(sums[i][1], _mm256_loadu_pd(row + 4));
+            }
+
+            _mm256_storeu_pd(row, sums[i][0]);
+            _mm256_storeu_pd(row + 4, sums[i][1]);
+        }
+    }
+
+    // Tile of 6 x 16 floats in 12 registers
+    TARGET static void gemm_kernel_f32(std::size_t kc, const float* a, const float* b, float* c, std::size_t c_stride, bool accumulate) {
+        __m256 sums[6][2];
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 6; i++) {
+            sums[i][0] = _mm256_setzero_ps();
+            sums[i][1] = _mm256_setzero_ps();
+        }
+
+        for (std::size_t p = 0; p < kc; p++) {
+            const __m256 b0 = _mm256_loadu_ps(b + p * 16);
+            const __m256 b1 = _mm256_loadu_ps(b + p * 16 + 8);
+
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < 6; i++) {
+                const __m256 x = _mm256_set1_ps(a[p * 6 + i]);
+                sums[i][0] = _mm256_fmadd_ps(x, b0, sums[i][0]);
+                sums[i][1] = _mm256_fmadd_ps(x, b1, sums[i][1]);
+            }
+        }
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 6; i++) {
+            float* row = c + i * c_stride;
+
+            if (accumulate) {
+                sums[i][0] = _mm256_add_ps(sums[i][0], _mm256_loadu_ps(row));
+                sums[i][1] = _mm256_add_ps(sums[i][1], _mm256_loadu_ps(row + 8));
+            }
+
+            _mm256_storeu_ps(row, sums[i][0]);
+            _mm256_storeu_ps(row + 8, sums[i][1]);
+        }
+    }
+
+    const Table& get_avx2_table() {
+        static const Table table {
+            dot_f64,
+            dot_f32,
+            dot_i8,
+            product_f64,
+            max_f64,
+            min_f64,
+            axpy_f64,
+            axpy_f32,
+            gemm::multiply<double, 6, 8, gemm_kernel_f64>,
+            gemm::multiply<float, 6, 16, gemm_kernel_f32>,
+            exp_polynomial_f64,
+            exp_table_f64,
+            tanh_polynomial_f64,
+            tanh_table_f64,
+            sigmoid_polynomial_f64,
+            sigmoid_table_f64
+        };
+
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,329 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+#include "table.hpp"
+#include "activations.hpp"
+#include "gemm.hpp"
+
+#ifdef KERNELS_X86
+
+#include <immintrin.h>
+
+// GCC's own AVX-512 intrinsics start from intentionally undefined vectors and trigger these warnings
+#if defined(__GNUC__) && !defined(__clang__)
+    #pragma GCC diagnostic ignored "-Wuninitialized"
+    #pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#define TARGET KERNELS_TARGET("avx512f")
+
+/*
+    The remainders are handled with masked loads, so there are no scalar tails.
+*/
+
+namespace kernels {
+    TARGET static __mmask8 tail_mask_f64(std::size_t count) {
+        return static_cast<__mmask8>((1u << count) - 1u);
+    }
+
+    TARGET static __mmask16 tail_mask_f32(std::size_t count) {
+        return static_cast<__mmask16>((1u << count) - 1u);
+    }
+
+    TARGET static double dot_f64(const double* a, const double* b, std::size_t size) {
+        __m512d sum0 = _mm512_setzero_pd();
+        __m512d sum1 = _mm512_setzero_pd();
+
+        std::size_t i = 0;
+
+        for (; i + 16 <= size; i += 16) {
+            sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), sum0);
+            sum1 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i + 8), _mm512_loadu_pd(b + i + 8), sum1);
+        }
+
+        for (; i + 8 <= size; i += 8) {
+            sum0 = _mm512_fmadd_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i), sum0);
+        }
+
+        if (i < size) {
+            const __mmask8 mask = tail_mask_f64(size - i);
+            sum1 = _mm512_fmadd_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i), sum1);
+        }
+
+        return _mm512_reduce_add_pd(_mm512_add_pd(sum0, sum1));
+    }
+
+    TARGET static float dot_f32(const float* a, const float* b, std::size_t size) {
+        __m512 sum0 = _mm512_setzero_ps();
+        __m512 sum1 = _mm512_setzero_ps();
+
+        std::size_t i = 0;
+
+        for (; i + 32 <= size; i += 32) {
+            sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+            sum1 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i + 16), _mm512_loadu_ps(b + i + 16), sum1);
+        }
+
+        for (; i + 16 <= size; i += 16) {
+            sum0 = _mm512_fmadd_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i), sum0);
+        }
+
+        if (i < size) {
+            const __mmask16 mask = tail_mask_f32(size - i);
+            sum1 = _mm512_fmadd_ps(_mm512_maskz_loadu_ps(mask, a + i), _mm512_maskz_loadu_ps(mask, b + i), sum1);
+        }
+
+        return _mm512_reduce_add_ps(_mm512_add_ps(sum0, sum1));
+    }
+
+    // AVX-512F alone has no 16 bit multiply-add, so the bytes are sign extended straight to 32 bits
+    TARGET static std::int32_t dot_i8(const std::int8_t* a, const std::int8_t* b, std::size_t size) {
+        __m512i sum = _mm512_setzero_si512();
+
+        std::size_t i = 0;
+
+        for (; i + 16 <= size; i += 16) {
+            const __m512i x = _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)));
+            const __m512i y = _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i)));
+
+            sum = _mm512_add_epi32(sum, _mm512_mullo_epi32(x, y));
+        }
+
+        if (i < size) {
+            // Byte masked loads need AVX-512BW, so copy the remainder into zeroed blocks
+            std::int8_t x_tail[16] {};
+            std::int8_t y_tail[16] {};
+            std::memcpy(x_tail, a + i, size - i);
+            std::memcpy(y_tail, b + i, size - i);
+
+            const __m512i x = _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(x_tail)));
+            const __m512i y = _mm512_cvtepi8_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(y_tail)));
+
+            sum = _mm512_add_epi32(sum, _mm512_mullo_epi32(x, y));
+        }
+
+        return _mm512_reduce_add_epi32(sum);
+    }
+
+    TARGET static double product_f64(const double* a, const double* b, std::size_t size) {
+        __m512d accumulator = _mm512_set1_pd(1.0);
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            accumulator = _mm512_mul_pd(accumulator, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        }
+
+        if (i < size) {
+            // Masked off lanes keep the accumulator as it is
+            const __mmask8 mask = tail_mask_f64(size - i);
+            const __m512d products = _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i));
+            accumulator = _mm512_mask_mul_pd(accumulator, mask, accumulator, products);
+        }
+
+        return _mm512_reduce_mul_pd(accumulator);
+    }
+
+    TARGET static double max_f64(const double* a, const double* b, std::size_t size) {
+        __m512d accumulator = _mm512_set1_pd(-std::numeric_limits<double>::infinity());
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            accumulator = _mm512_max_pd(accumulator, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        }
+
+        if (i < size) {
+            const __mmask8 mask = tail_mask_f64(size - i);
+            const __m512d products = _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i));
+            accumulator = _mm512_mask_max_pd(accumulator, mask, accumulator, products);
+        }
+
+        return _mm512_reduce_max_pd(accumulator);
+    }
+
+    TARGET static double min_f64(const double* a, const double* b, std::size_t size) {
+        __m512d accumulator = _mm512_set1_pd(std::numeric_limits<double>::infinity());
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            accumulator = _mm512_min_pd(accumulator, _mm512_mul_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        }
+
+        if (i < size) {
+            const __mmask8 mask = tail_mask_f64(size - i);
+            const __m512d products = _mm512_mul_pd(_mm512_maskz_loadu_pd(mask, a + i), _mm512_maskz_loadu_pd(mask, b + i));
+            accumulator = _mm512_mask_min_pd(accumulator, mask, accumulator, products);
+        }
+
+        return _mm512_reduce_min_pd(accumulator);
+    }
+
+    TARGET static void axpy_f64(double alpha, const double* x, double* y, std::size_t size) {
+        const __m512d factor = _mm512_set1_pd(alpha);
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            _mm512_storeu_pd(y + i, _mm512_fmadd_pd(factor, _mm512_loadu_pd(x + i), _mm512_loadu_pd(y + i)));
+        }
+
+        if (i < size) {
+            const __mmask8 mask = tail_mask_f64(size - i);
+            const __m512d result = _mm512_fmadd_pd(factor, _mm512_maskz_loadu_pd(mask, x + i), _mm512_maskz_loadu_pd(mask, y + i));
+            _mm512_mask_storeu_pd(y + i, mask, result);
+        }
+    }
+
+    TARGET static void axpy_f32(float alpha, const float* x, float* y, std::size_t size) {
+        const __m512 factor = _mm512_set1_ps(alpha);
+
+        std::size_t i = 0;
+
+        for (; i + 16 <= size; i += 16) {
+            _mm512_storeu_ps(y + i, _mm512_fmadd_ps(factor, _mm512_loadu_ps(x + i), _mm512_loadu_ps(y + i)));
+        }
+
+        if (i < size) {
+            const __mmask16 mask = tail_mask_f32(size - i);
+            const __m512 result = _mm512_fmadd_ps(factor, _mm512_maskz_loadu_ps(mask, x + i), _mm512_maskz_loadu_ps(mask, y + i));
+            _mm512_mask_storeu_ps(y + i, mask, result);
+        }
+    }
+
+    TARGET static void exp_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void exp_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_table(x[i]);
+        }
+    }
+
+    TARGET static void tanh_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void tanh_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_table(x[i]);
+        }
+    }
+
+    TARGET static void sigmoid_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void sigmoid_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_table(x[i]);
+        }
+    }
+
+    // Tile of 8 x 16 doubles in 16 registers
+    TARGET static void gemm_kernel_f64(std::size_t kc, const double* a, const double* b, double* c, std::size_t c_stride, bool accumulate) {
+        __m512d sums[8][2];
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 8; i++) {
+            sums[i][0] = _mm512_setzero_pd();
+            sums[i][1] = _mm512_setzero_pd();
+        }
+
+        for (std::size_t p = 0; p < kc; p++) {
+            const __m512d b0 = _mm512_loadu_pd(b + p * 16);
+            const __m512d b1 = _mm512_loadu_pd(b + p * 16 + 8);
+
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < 8; i++) {
+                const __m512d x = _mm512_set1_pd(a[p * 8 + i]);
+                sums[i][0] = _mm512_fmadd_pd(x, b0, sums[i][0]);
+                sums[i][1] = _mm512_fmadd_pd(x, b1, sums[i][1]);
+            }
+        }
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 8; i++) {
+            double* row = c + i * c_stride;
+
+            if (accumulate) {
+                sums[i][0] = _mm512_add_pd(sums[i][0], _mm512_loadu_pd(row));
+                sums[i][1] = _mm512_add_pd(sums[i][1], _mm512_loadu_pd(row + 8));
+            }
+
+            _mm512_storeu_pd(row, sums[i][0]);
+            _mm512_storeu_pd(row + 8, sums[i][1]);
+        }
+    }
+
+    // Tile of 8 x 32 floats in 16 registers
+    TARGET static void gemm_kernel_f32(std::size_t kc, const float* a, const float* b, float* c, std::size_t c_stride, bool accumulate) {
+        __m512 sums[8][2];
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 8; i++) {
+            sums[i][0] = _mm512_setzero_ps();
+            sums[i][1] = _mm512_setzero_ps();
+        }
+
+        for (std::size_t p = 0; p < kc; p++) {
+            const __m512 b0 = _mm512_loadu_ps(b + p * 32);
+            const __m512 b1 = _mm512_loadu_ps(b + p * 32 + 16);
+
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < 8; i++) {
+                const __m512 x = _mm512_set1_ps(a[p * 8 + i]);
+                sums[i][0] = _mm512_fmadd_ps(x, b0, sums[i][0]);
+                sums[i][1] = _mm512_fmadd_ps(x, b1, sums[i][1]);
+            }
+        }
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 8; i++) {
+            float* row = c + i * c_stride;
+
+            if (accumulate) {
+                sums[i][0] = _mm512_add_ps(sums[i][0], _mm512_loadu_ps(row));
+                sums[i][1] = _mm512_add_ps(sums[i][1], _mm512_loadu_ps(row + 16));
+            }
+
+            _mm512_storeu_ps(row, sums[i][0]);
+            _mm512_storeu_ps(row + 16, sums[i][1]);
+        }
+    }
+
+    const Table& get_avx512_table() {
+        static const Table table {
+            dot_f64,
+            dot_f32,
+            dot_i8,
+            product_f64,
+            max_f64,
+            min_f64,
+            axpy_f64,
+            axpy_f32,
+            gemm::multiply<double, 8, 16, gemm_kernel_f64>,
+            gemm::multiply<float, 8, 32, gemm_kernel_f32>,
+            exp_polynomial_f64,
+            exp_table_f64,
+            tanh_polynomial_f64,
+            tanh_table_f64,
+            sigmoid_polynomial_f64,
+            sigmoid_table_f64
+        };
+
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,133 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <algorithm>
+
+/*
+    Driver of the matrix product c = a * b^T, shared by every level; only the micro kernel differs.
+
+    The product is split in blocks that fit the caches: KC columns of both operands at a time, MC
+    rows of a for the second level cache and NC rows of b for the third. Each block is first copied
+    into a packed panel, a sequence of slivers of MR rows of a (or NR rows of b) stored column by
+    column, so that the micro kernel reads both operands contiguously and keeps its whole MR x NR
+    tile of c in registers. The slivers at the edges are padded with zeros and their tile goes
+    through a temporary buffer.
+*/
+
+// Let the compiler unroll the short loops over the registers of a tile
+#if defined(__clang__)
+    #define KERNELS_UNROLL _Pragma("unroll")
+#elif defined(__GNUC__)
+    #define KERNELS_UNROLL _Pragma("GCC unroll 16")
+#else
+    #define KERNELS_UNROLL
+#endif
+
+namespace kernels::gemm {
+    inline constexpr std::size_t KC = 256;
+    inline constexpr std::size_t MC = 96;
+    inline constexpr std::size_t NC = 2048;
+
+    // Tile of c (MR x NR, with a stride) = (or +=, if accumulating) kc packed columns of a and b
+    template<typename Real>
+    using MicroKernel = void (*)(std::size_t kc, const Real* a, const Real* b, Real* c, std::size_t c_stride, bool accumulate);
+
+    // Slivers of Slice rows of a matrix, column by column, padded with zeros to a whole sliver
+    template<typename Real, std::size_t Slice>
+    void pack(const Real* x, std::size_t x_stride, std::size_t rows, std::size_t columns, Real* panel) {
+        for (std::size_t begin = 0; begin < rows; begin += Slice) {
+            const std::size_t count = std::min(Slice, rows - begin);
+
+            for (std::size_t i = 0; i < count; i++) {
+                const Real* row = x + (begin + i) * x_stride;
+
+                for (std::size_t p = 0; p < columns; p++) {
+                    panel[p * Slice + i] = row[p];
+                }
+            }
+
+            for (std::size_t i = count; i < Slice; i++) {
+                for (std::size_t p = 0; p < columns; p++) {
+                    panel[p * Slice + i] = static_cast<Real>(0.0);
+                }
+            }
+
+            panel += Slice * columns;
+        }
+    }
+
+    template<typename Real, std::size_t MR, std::size_t NR, MicroKernel<Real> Kernel>
+    void multiply(
+        std::size_t m,
+        std::size_t n,
+        std::size_t k,
+        const Real* a,
+        std::size_t a_stride,
+        const Real* b,
+        std::size_t b_stride,
+        Real* c,
+        std::size_t c_stride
+    ) {
+        static_assert(MC % MR == 0 && NC % NR == 0);
+
+        if (k == 0) {
+            for (std::size_t i = 0; i < m; i++) {
+                std::fill_n(c + i * c_stride, n, static_cast<Real>(0.0));
+            }
+
+            return;
+        }
+
+        // Each thread packs into its own panels, which are kept between calls
+        thread_local std::vector<Real> a_panel;
+        thread_local std::vector<Real> b_panel;
+
+        a_panel.resize(MC * KC);
+        b_panel.resize(std::min(NC, (n + NR - 1) / NR * NR) * KC);
+
+        Real tile[MR * NR];
+
+        for (std::size_t jc = 0; jc < n; jc += NC) {
+            const std::size_t nc = std::min(NC, n - jc);
+
+            for (std::size_t pc = 0; pc < k; pc += KC) {
+                const std::size_t kc = std::min(KC, k - pc);
+                const bool accumulate = pc > 0;
+
+                pack<Real, NR>(b + jc * b_stride + pc, b_stride, nc, kc, b_panel.data());
+
+                for (std::size_t ic = 0; ic < m; ic += MC) {
+                    const std::size_t mc = std::min(MC, m - ic);
+
+                    pack<Real, MR>(a + ic * a_stride + pc, a_stride, mc, kc, a_panel.data());
+
+                    for (std::size_t jr = 0; jr < nc; jr += NR) {
+                        const std::size_t nr = std::min(NR, nc - jr);
+                        const Real* b_sliver = b_panel.data() + jr * kc;
+
+                        for (std::size_t ir = 0; ir < mc; ir += MR) {
+                            const std::size_t mr = std::min(MR, mc - ir);
+                            const Real* a_sliver = a_panel.data() + ir * kc;
+                            Real* c_tile = c + (ic + ir) * c_stride + jc + jr;
+
+                            if (mr == MR && nr == NR) {
+                                Kernel(kc, a_sliver, b_sliver, c_tile, c_stride, accumulate);
+                                continue;
+                            }
+
+                            Kernel(kc, a_sliver, b_sliver, tile, NR, false);
+
+                            for (std::size_t i = 0; i < mr; i++) {
+                                for (std::size_t j = 0; j < nr; j++) {
+                                    Real& result = c_tile[i * c_stride + j];
+                                    result = accumulate ? result + tile[i * NR + j] : tile[i * NR + j];
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,377 @@
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <atomic>
+#include <algorithm>
+#include <cmath>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    #include <intrin.h>
+    #include <immintrin.h>
+#endif
+
+#include "kernels/kernels.hpp"
+#include "table.hpp"
+#include "activations.hpp"
+
+namespace kernels {
+    static const Table& get_table(Level level);
+
+    struct State {
+        State(Level level, Accuracy accuracy)
+            : table(&get_table(level)), level(level), accuracy(accuracy) {}
+
+        std::atomic<const Table*> table;
+        std::atomic<Level> level;
+        std::atomic<Accuracy> accuracy;
+    };
+
+    static bool is_supported(Level level) {
+        return static_cast<int>(level) <= static_cast<int>(detect_level());
+    }
+
+    static const Table& get_table(Level level) {
+        switch (level) {
+            case Level::Scalar:
+                break;
+#ifdef KERNELS_X86
+            case Level::Sse2:
+                return get_sse2_table();
+            case Level::Avx2:
+                return get_avx2_table();
+            case Level::Avx512:
+                return get_avx512_table();
+#else
+            default:
+                break;
+#endif
+        }
+
+        return get_scalar_table();
+    }
+
+    static Level initial_level() {
+        const Level detected = detect_level();
+        const char* variable = std::getenv("KERNELS_LEVEL");
+
+        if (variable == nullptr) {
+            return detected;
+        }
+
+        for (Level level : { Level::Scalar, Level::Sse2, Level::Avx2, Level::Avx512 }) {
+            if (std::strcmp(variable, get_level_name(level)) == 0 && is_supported(level)) {
+                return level;
+            }
+        }
+
+        return detected;
+    }
+
+    static Accuracy initial_accuracy() {
+        const char* variable = std::getenv("KERNELS_ACCURACY");
+
+        if (variable == nullptr) {
+            return Accuracy::Exact;
+        }
+
+        for (Accuracy accuracy : { Accuracy::Exact, Accuracy::Polynomial, Accuracy::Table }) {
+            if (std::strcmp(variable, get_accuracy_name(accuracy)) == 0) {
+                return accuracy;
+            }
+        }
+
+        return Accuracy::Exact;
+    }
+
+    static State& get_state() {
+        static State state {initial_level(), initial_accuracy()};
+
+        return state;
+    }
+
+    static const Table& table() {
+        return *get_state().table.load(std::memory_order_relaxed);
+    }
+
+    // The approximations exist only for double, so float arrays go through them in small blocks
+    static void widen(void (*function)(double*, std::size_t), float* x, std::size_t size) {
+        constexpr std::size_t BLOCK = 64;
+
+        double buffer[BLOCK];
+
+        for (std::size_t begin = 0; begin < size; begin += BLOCK) {
+            const std::size_t count = std::min(BLOCK, size - begin);
+
+            for (std::size_t i = 0; i < count; i++) {
+                buffer[i] = x[begin + i];
+            }
+
+            function(buffer, count);
+
+            for (std::size_t i = 0; i < count; i++) {
+                x[begin + i] = static_cast<float>(buffer[i]);
+            }
+        }
+    }
+
+    Level detect_level() {
+#if defined(KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+        static const Level level = []() {
+            __builtin_cpu_init();
+
+            if (__builtin_cpu_supports("avx512f")) {
+                return Level::Avx512;
+            } else if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+                return Level::Avx2;
+            } else if (__builtin_cpu_supports("sse2")) {
+                return Level::Sse2;
+            }
+
+            return Level::Scalar;
+        }();
+
+        return level;
+#elif defined(KERNELS_X86) && defined(_MSC_VER)
+        static const Level level = []() {
+            int registers[4] {};
+
+            __cpuid(registers, 1);
+            const bool sse2 = (registers[3] & (1 << 26)) != 0;
+            const bool fma = (registers[2] & (1 << 12)) != 0;
+            const bool os_saves_ymm = (registers[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+            const bool os_saves_zmm = os_saves_ymm && (_xgetbv(0) & 0xe6) == 0xe6;
+
+            __cpuidex(registers, 7, 0);
+            const bool avx2 = (registers[1] & (1 << 5)) != 0;
+            const bool avx512f = (registers[1] & (1 << 16)) != 0;
+
+            if (avx512f && os_saves_zmm) {
+                return Level::Avx512;
+            } else if (avx2 && fma && os_saves_ymm) {
+                return Level::Avx2;
+            } else if (sse2) {
+                return Level::Sse2;
+            }
+
+            return Level::Scalar;
+        }();
+
+        return level;
+#else
+        return Level::Scalar;
+#endif
+    }
+
+    Level get_level() {
+        return get_state().level.load(std::memory_order_relaxed);
+    }
+
+    bool force_level(Level level) {
+        if (!is_supported(level)) {
+            return false;
+        }
+
+        State& state = get_state();
+        state.table.store(&get_table(level), std::memory_order_relaxed);
+        state.level.store(level, std::memory_order_relaxed);
+
+        return true;
+    }
+
+    const char* get_level_name(Level level) {
+        switch (level) {
+            case Level::Scalar:
+                return "scalar";
+            case Level::Sse2:
+                return "sse2";
+            case Level::Avx2:
+                return "avx2";
+            case Level::Avx512:
+                return "avx512";
+        }
+
+        return "unknown";
+    }
+
+    Accuracy get_accuracy() {
+        return get_state().accuracy.load(std::memory_order_relaxed);
+    }
+
+    void set_accuracy(Accuracy accuracy) {
+        get_state().accuracy.store(accuracy, std::memory_order_relaxed);
+    }
+
+    const char* get_accuracy_name(Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                return "exact";
+            case Accuracy::Polynomial:
+                return "polynomial";
+            case Accuracy::Table:
+                return "table";
+        }
+
+        return "unknown";
+    }
+
+    double dot(const double* a, const double* b, std::size_t size) {
+        return table().dot_f64(a, b, size);
+    }
+
+    float dot(const float* a, const float* b, std::size_t size) {
+        return table().dot_f32(a, b, size);
+    }
+
+    std::int32_t dot(const std::int8_t* a, const std::int8_t* b, std::size_t size) {
+        return table().dot_i8(a, b, size);
+    }
+
+    double product(const double* a, const double* b, std::size_t size) {
+        return table().product_f64(a, b, size);
+    }
+
+    double max(const double* a, const double* b, std::size_t size) {
+        return table().max_f64(a, b, size);
+    }
+
+    double min(const double* a, const double* b, std::size_t size) {
+        return table().min_f64(a, b, size);
+    }
+
+    void axpy(double alpha, const double* x, double* y, std::size_t size) {
+        table().axpy_f64(alpha, x, y, size);
+    }
+
+    void axpy(float alpha, const float* x, float* y, std::size_t size) {
+        table().axpy_f32(alpha, x, y, size);
+    }
+
+    void gemm(std::size_t m, std::size_t n, std::size_t k, const double* a, std::size_t a_stride, const double* b, std::size_t b_stride, double* c, std::size_t c_stride) {
+        table().gemm_f64(m, n, k, a, a_stride, b, b_stride, c, c_stride);
+    }
+
+    void gemm(std::size_t m, std::size_t n, std::size_t k, const float* a, std::size_t a_stride, const float* b, std::size_t b_stride, float* c, std::size_t c_stride) {
+        table().gemm_f32(m, n, k, a, a_stride, b, b_stride, c, c_stride);
+    }
+
+    void exp(double* x, std::size_t size) {
+        exp(x, size, get_accuracy());
+    }
+
+    void tanh(double* x, std::size_t size) {
+        tanh(x, size, get_accuracy());
+    }
+
+    void sigmoid(double* x, std::size_t size) {
+        sigmoid(x, size, get_accuracy());
+    }
+
+    void exp(float* x, std::size_t size) {
+        exp(x, size, get_accuracy());
+    }
+
+    void tanh(float* x, std::size_t size) {
+        tanh(x, size, get_accuracy());
+    }
+
+    void sigmoid(float* x, std::size_t size) {
+        sigmoid(x, size, get_accuracy());
+    }
+
+    void exp(double* x, std::size_t size, Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                for (std::size_t i = 0; i < size; i++) {
+                    x[i] = activations::exp_exact(x[i]);
+                }
+                break;
+            case Accuracy::Polynomial:
+                table().exp_polynomial_f64(x, size);
+                break;
+            case Accuracy::Table:
+                table().exp_table_f64(x, size);
+                break;
+        }
+    }
+
+    void tanh(double* x, std::size_t size, Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                for (std::size_t i = 0; i < size; i++) {
+                    x[i] = activations::tanh_exact(x[i]);
+                }
+                break;
+            case Accuracy::Polynomial:
+                table().tanh_polynomial_f64(x, size);
+                break;
+            case Accuracy::Table:
+                table().tanh_table_f64(x, size);
+                break;
+        }
+    }
+
+    void sigmoid(double* x, std::size_t size, Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                for (std::size_t i = 0; i < size; i++) {
+                    x[i] = activations::sigmoid_exact(x[i]);
+                }
+                break;
+            case Accuracy::Polynomial:
+                table().sigmoid_polynomial_f64(x, size);
+                break;
+            case Accuracy::Table:
+                table().sigmoid_table_f64(x, size);
+                break;
+        }
+    }
+
+    void exp(float* x, std::size_t size, Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                for (std::size_t i = 0; i < size; i++) {
+                    x[i] = std::exp(x[i]);
+                }
+                break;
+            case Accuracy::Polynomial:
+                widen(table().exp_polynomial_f64, x, size);
+                break;
+            case Accuracy::Table:
+                widen(table().exp_table_f64, x, size);
+                break;
+        }
+    }
+
+    void tanh(float* x, std::size_t size, Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                for (std::size_t i = 0; i < size; i++) {
+                    x[i] = std::tanh(x[i]);
+                }
+                break;
+            case Accuracy::Polynomial:
+                widen(table().tanh_polynomial_f64, x, size);
+                break;
+            case Accuracy::Table:
+                widen(table().tanh_table_f64, x, size);
+                break;
+        }
+    }
+
+    void sigmoid(float* x, std::size_t size, Accuracy accuracy) {
+        switch (accuracy) {
+            case Accuracy::Exact:
+                for (std::size_t i = 0; i < size; i++) {
+                    x[i] = 1.0f / (1.0f + std::exp(-x[i]));
+                }
+                break;
+            case Accuracy::Polynomial:
+                widen(table().sigmoid_polynomial_f64, x, size);
+                break;
+            case Accuracy::Table:
+                widen(table().sigmoid_table_f64, x, size);
+                break;
+        }
+    }
+}
@@ -0,0 +1,151 @@
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include "table.hpp"
+#include "activations.hpp"
+#include "gemm.hpp"
+
+namespace kernels {
+    template<typename Real>
+    static Real dot(const Real* a, const Real* b, std::size_t size) {
+        Real result = static_cast<Real>(0.0);
+
+        for (std::size_t i = 0; i < size; i++) {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    static std::int32_t dot_i8(const std::int8_t* a, const std::int8_t* b, std::size_t size) {
+        std::int32_t result = 0;
+
+        for (std::size_t i = 0; i < size; i++) {
+            result += static_cast<std::int32_t>(a[i]) * static_cast<std::int32_t>(b[i]);
+        }
+
+        return result;
+    }
+
+    static double product(const double* a, const double* b, std::size_t size) {
+        double result = 1.0;
+
+        for (std::size_t i = 0; i < size; i++) {
+            result *= a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    static double max(const double* a, const double* b, std::size_t size) {
+        double result = -std::numeric_limits<double>::infinity();
+
+        for (std::size_t i = 0; i < size; i++) {
+            result = std::max(result, a[i] * b[i]);
+        }
+
+        return result;
+    }
+
+    static double min(const double* a, const double* b, std::size_t size) {
+        double result = std::numeric_limits<double>::infinity();
+
+        for (std::size_t i = 0; i < size; i++) {
+            result = std::min(result, a[i] * b[i]);
+        }
+
+        return result;
+    }
+
+    template<typename Real>
+    static void axpy(Real alpha, const Real* x, Real* y, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    template<typename Real>
+    static void gemm_kernel(std::size_t kc, const Real* a, const Real* b, Real* c, std::size_t c_stride, bool accumulate) {
+        constexpr std::size_t MR = 4;
+        constexpr std::size_t NR = 4;
+
+        Real sums[MR][NR] {};
+
+        for (std::size_t p = 0; p < kc; p++) {
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < MR; i++) {
+                KERNELS_UNROLL
+                for (std::size_t j = 0; j < NR; j++) {
+                    sums[i][j] += a[p * MR + i] * b[p * NR + j];
+                }
+            }
+        }
+
+        for (std::size_t i = 0; i < MR; i++) {
+            for (std::size_t j = 0; j < NR; j++) {
+                c[i * c_stride + j] = accumulate ? c[i * c_stride + j] + sums[i][j] : sums[i][j];
+            }
+        }
+    }
+
+    static void exp_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_polynomial(x[i]);
+        }
+    }
+
+    static void exp_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_table(x[i]);
+        }
+    }
+
+    static void tanh_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_polynomial(x[i]);
+        }
+    }
+
+    static void tanh_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_table(x[i]);
+        }
+    }
+
+    static void sigmoid_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_polynomial(x[i]);
+        }
+    }
+
+    static void sigmoid_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_table(x[i]);
+        }
+    }
+
+    const Table& get_scalar_table() {
+        static const Table table {
+            dot<double>,
+            dot<float>,
+            dot_i8,
+            product,
+            max,
+            min,
+            axpy<double>,
+            axpy<float>,
+            gemm::multiply<double, 4, 4, gemm_kernel<double>>,
+            gemm::multiply<float, 4, 4, gemm_kernel<float>>,
+            exp_polynomial_f64,
+            exp_table_f64,
+            tanh_polynomial_f64,
+            tanh_table_f64,
+            sigmoid_polynomial_f64,
+            sigmoid_table_f64
+        };
+
+        return table;
+    }
+}
@@ -0,0 +1,317 @@
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <limits>
+
+#include "table.hpp"
+#include "activations.hpp"
+#include "gemm.hpp"
+
+#ifdef KERNELS_X86
+
+#include <immintrin.h>
+
+#define TARGET KERNELS_TARGET("sse2")
+
+namespace kernels {
+    TARGET static double horizontal_add(__m128d x) {
+        return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+    }
+
+    TARGET static float horizontal_add(__m128 x) {
+        x = _mm_add_ps(x, _mm_movehl_ps(x, x));
+        x = _mm_add_ss(x, _mm_shuffle_ps(x, x, 0x1));
+
+        return _mm_cvtss_f32(x);
+    }
+
+    TARGET static double dot_f64(const double* a, const double* b, std::size_t size) {
+        __m128d sum0 = _mm_setzero_pd();
+        __m128d sum1 = _mm_setzero_pd();
+
+        std::size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            sum0 = _mm_add_pd(sum0, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+            sum1 = _mm_add_pd(sum1, _mm_mul_pd(_mm_loadu_pd(a + i + 2), _mm_loadu_pd(b + i + 2)));
+        }
+
+        double result = horizontal_add(_mm_add_pd(sum0, sum1));
+
+        for (; i < size; i++) {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    TARGET static float dot_f32(const float* a, const float* b, std::size_t size) {
+        __m128 sum0 = _mm_setzero_ps();
+        __m128 sum1 = _mm_setzero_ps();
+
+        std::size_t i = 0;
+
+        for (; i + 8 <= size; i += 8) {
+            sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(a + i), _mm_loadu_ps(b + i)));
+            sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(a + i + 4), _mm_loadu_ps(b + i + 4)));
+        }
+
+        float result = horizontal_add(_mm_add_ps(sum0, sum1));
+
+        for (; i < size; i++) {
+            result += a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    TARGET static std::int32_t horizontal_add(__m128i x) {
+        x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0x4e));
+        x = _mm_add_epi32(x, _mm_shuffle_epi32(x, 0xb1));
+
+        return _mm_cvtsi128_si32(x);
+    }
+
+    TARGET static std::int32_t dot_i8(const std::int8_t* a, const std::int8_t* b, std::size_t size) {
+        __m128i sum = _mm_setzero_si128();
+
+        std::size_t i = 0;
+
+        for (; i + 16 <= size; i += 16) {
+            const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+            const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+
+            // Without SSE4.1, sign extend to 16 bits by unpacking into the high bytes and shifting
+            const __m128i x_low = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);
+            const __m128i x_high = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+            const __m128i y_low = _mm_srai_epi16(_mm_unpacklo_epi8(y, y), 8);
+            const __m128i y_high = _mm_srai_epi16(_mm_unpackhi_epi8(y, y), 8);
+
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x_low, y_low));
+            sum = _mm_add_epi32(sum, _mm_madd_epi16(x_high, y_high));
+        }
+
+        std::int32_t result = horizontal_add(sum);
+
+        for (; i < size; i++) {
+            result += static_cast<std::int32_t>(a[i]) * static_cast<std::int32_t>(b[i]);
+        }
+
+        return result;
+    }
+
+    TARGET static double product_f64(const double* a, const double* b, std::size_t size) {
+        __m128d accumulator = _mm_set1_pd(1.0);
+
+        std::size_t i = 0;
+
+        for (; i + 2 <= size; i += 2) {
+            accumulator = _mm_mul_pd(accumulator, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        }
+
+        double result = _mm_cvtsd_f64(_mm_mul_sd(accumulator, _mm_unpackhi_pd(accumulator, accumulator)));
+
+        for (; i < size; i++) {
+            result *= a[i] * b[i];
+        }
+
+        return result;
+    }
+
+    TARGET static double max_f64(const double* a, const double* b, std::size_t size) {
+        __m128d accumulator = _mm_set1_pd(-std::numeric_limits<double>::infinity());
+
+        std::size_t i = 0;
+
+        for (; i + 2 <= size; i += 2) {
+            accumulator = _mm_max_pd(accumulator, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        }
+
+        double result = _mm_cvtsd_f64(_mm_max_sd(accumulator, _mm_unpackhi_pd(accumulator, accumulator)));
+
+        for (; i < size; i++) {
+            result = std::max(result, a[i] * b[i]);
+        }
+
+        return result;
+    }
+
+    TARGET static double min_f64(const double* a, const double* b, std::size_t size) {
+        __m128d accumulator = _mm_set1_pd(std::numeric_limits<double>::infinity());
+
+        std::size_t i = 0;
+
+        for (; i + 2 <= size; i += 2) {
+            accumulator = _mm_min_pd(accumulator, _mm_mul_pd(_mm_loadu_pd(a + i), _mm_loadu_pd(b + i)));
+        }
+
+        double result = _mm_cvtsd_f64(_mm_min_sd(accumulator, _mm_unpackhi_pd(accumulator, accumulator)));
+
+        for (; i < size; i++) {
+            result = std::min(result, a[i] * b[i]);
+        }
+
+        return result;
+    }
+
+    TARGET static void axpy_f64(double alpha, const double* x, double* y, std::size_t size) {
+        const __m128d factor = _mm_set1_pd(alpha);
+
+        std::size_t i = 0;
+
+        for (; i + 2 <= size; i += 2) {
+            _mm_storeu_pd(y + i, _mm_add_pd(_mm_loadu_pd(y + i), _mm_mul_pd(factor, _mm_loadu_pd(x + i))));
+        }
+
+        for (; i < size; i++) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    TARGET static void axpy_f32(float alpha, const float* x, float* y, std::size_t size) {
+        const __m128 factor = _mm_set1_ps(alpha);
+
+        std::size_t i = 0;
+
+        for (; i + 4 <= size; i += 4) {
+            _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_mul_ps(factor, _mm_loadu_ps(x + i))));
+        }
+
+        for (; i < size; i++) {
+            y[i] += alpha * x[i];
+        }
+    }
+
+    TARGET static void exp_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void exp_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::exp_table(x[i]);
+        }
+    }
+
+    TARGET static void tanh_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void tanh_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::tanh_table(x[i]);
+        }
+    }
+
+    TARGET static void sigmoid_polynomial_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_polynomial(x[i]);
+        }
+    }
+
+    TARGET static void sigmoid_table_f64(double* x, std::size_t size) {
+        for (std::size_t i = 0; i < size; i++) {
+            x[i] = activations::sigmoid_table(x[i]);
+        }
+    }
+
+    // Tile of 4 x 4 doubles in 8 registers
+    TARGET static void gemm_kernel_f64(std::size_t kc, const double* a, const double* b, double* c, std::size_t c_stride, bool accumulate) {
+        __m128d sums[4][2];
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 4; i++) {
+            sums[i][0] = _mm_setzero_pd();
+            sums[i][1] = _mm_setzero_pd();
+        }
+
+        for (std::size_t p = 0; p < kc; p++) {
+            const __m128d b0 = _mm_loadu_pd(b + p * 4);
+            const __m128d b1 = _mm_loadu_pd(b + p * 4 + 2);
+
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < 4; i++) {
+                const __m128d x = _mm_set1_pd(a[p * 4 + i]);
+                sums[i][0] = _mm_add_pd(sums[i][0], _mm_mul_pd(x, b0));
+                sums[i][1] = _mm_add_pd(sums[i][1], _mm_mul_pd(x, b1));
+            }
+        }
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 4; i++) {
+            double* row = c + i * c_stride;
+
+            if (accumulate) {
+                sums[i][0] = _mm_add_pd(sums[i][0], _mm_loadu_pd(row));
+                sums[i][1] = _mm_add_pd(sums[i][1], _mm_loadu_pd(row + 2));
+            }
+
+            _mm_storeu_pd(row, sums[i][0]);
+            _mm_storeu_pd(row + 2, sums[i][1]);
+        }
+    }
+
+    // Tile of 4 x 8 floats in 8 registers
+    TARGET static void gemm_kernel_f32(std::size_t kc, const float* a, const float* b, float* c, std::size_t c_stride, bool accumulate) {
+        __m128 sums[4][2];
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 4; i++) {
+            sums[i][0] = _mm_setzero_ps();
+            sums[i][1] = _mm_setzero_ps();
+        }
+
+        for (std::size_t p = 0; p < kc; p++) {
+            const __m128 b0 = _mm_loadu_ps(b + p * 8);
+            const __m128 b1 = _mm_loadu_ps(b + p * 8 + 4);
+
+            KERNELS_UNROLL
+            for (std::size_t i = 0; i < 4; i++) {
+                const __m128 x = _mm_set1_ps(a[p * 4 + i]);
+                sums[i][0] = _mm_add_ps(sums[i][0], _mm_mul_ps(x, b0));
+                sums[i][1] = _mm_add_ps(sums[i][1], _mm_mul_ps(x, b1));
+            }
+        }
+
+        KERNELS_UNROLL
+        for (std::size_t i = 0; i < 4; i++) {
+            float* row = c + i * c_stride;
+
+            if (accumulate) {
+                sums[i][0] = _mm_add_ps(sums[i][0], _mm_loadu_ps(row));
+                sums[i][1] = _mm_add_ps(sums[i][1], _mm_loadu_ps(row + 4));
+            }
+
+            _mm_storeu_ps(row, sums[i][0]);
+            _mm_storeu_ps(row + 4, sums[i][1]);
+        }
+    }
+
+    const Table& get_sse2_table() {
+        static const Table table {
+            dot_f64,
+            dot_f32,
+            dot_i8,
+            product_f64,
+            max_f64,
+            min_f64,
+            axpy_f64,
+            axpy_f32,
+            gemm::multiply<double, 4, 4, gemm_kernel_f64>,
+            gemm::multiply<float, 4, 8, gemm_kernel_f32>,
+            exp_polynomial_f64,
+            exp_table_f64,
+            tanh_polynomial_f64,
+            tanh_table_f64,
+            sigmoid_polynomial_f64,
+            sigmoid_table_f64
+        };
+
+        return table;
+    }
+}
+
+#endif
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+    #define KERNELS_X86
+#endif
+
+// Let the compiler emit instructions of a specific extension in a single function
+#if defined(__GNUC__) || defined(__clang__)
+    #define KERNELS_TARGET(EXTENSIONS) __attribute__((target(EXTENSIONS)))
+#else
+    #define KERNELS_TARGET(EXTENSIONS)
+#endif
+
+namespace kernels {
+    struct Table {
+        double (*dot_f64)(const double*, const double*, std::size_t) = nullptr;
+        float (*dot_f32)(const float*, const float*, std::size_t) = nullptr;
+        std::int32_t (*dot_i8)(const std::int8_t*, const std::int8_t*, std::size_t) = nullptr;
+        double (*product_f64)(const double*, const double*, std::size_t) = nullptr;
+        double (*max_f64)(const double*, const double*, std::size_t) = nullptr;
+        double (*min_f64)(const double*, const double*, std::size_t) = nullptr;
+        void (*axpy_f64)(double, const double*, double*, std::size_t) = nullptr;
+        void (*axpy_f32)(float, const float*, float*, std::size_t) = nullptr;
+        void (*gemm_f64)(std::size_t, std::size_t, std::size_t, const double*, std::size_t, const double*, std::size_t, double*, std::size_t) = nullptr;
+        void (*gemm_f32)(std::size_t, std::size_t, std::size_t, const float*, std::size_t, const float*, std::size_t, float*, std::size_t) = nullptr;
+        void (*exp_polynomial_f64)(double*, std::size_t) = nullptr;
+        void (*exp_table_f64)(double*, std::size_t) = nullptr;
+        void (*tanh_polynomial_f64)(double*, std::size_t) = nullptr;
+        void (*tanh_table_f64)(double*, std::size_t) = nullptr;
+        void (*sigmoid_polynomial_f64)(double*, std::size_t) = nullptr;
+        void (*sigmoid_table_f64)(double*, std::size_t) = nullptr;
+    };
+
+    const Table& get_scalar_table();
+
+#ifdef KERNELS_X86
+    const Table& get_sse2_table();
+    const Table& get_avx2_table();
+    const Table& get_avx512_table();
+#endif
+}
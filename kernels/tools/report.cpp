@@ -0,0 +1,106 @@
+#include <cstddef>
+#include <cstdio>
+#include <cmath>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+#include <kernels/kernels.hpp>
+
+/*
+    Accuracy of the activations against the C library, for every tier and instruction set
+    supported by this CPU, together with their speed.
+*/
+
+struct Function {
+    const char* name;
+    double begin;
+    double end;
+    void (*kernel)(double*, std::size_t, kernels::Accuracy);
+    double (*reference)(double);
+};
+
+static double reference_sigmoid(double x) {
+    return 1.0 / (1.0 + std::exp(-x));
+}
+
+static double reference_exp(double x) {
+    return std::exp(x);
+}
+
+static double reference_tanh(double x) {
+    return std::tanh(x);
+}
+
+static void report(const Function& function, kernels::Accuracy accuracy) {
+    static constexpr std::size_t SAMPLES = 1'000'000;
+    static constexpr int REPETITIONS = 20;
+
+    std::vector<double> inputs(SAMPLES);
+    std::vector<double> outputs(SAMPLES);
+
+    for (std::size_t i = 0; i < SAMPLES; i++) {
+        inputs[i] = function.begin + (function.end - function.begin) * static_cast<double>(i) / static_cast<double>(SAMPLES - 1);
+    }
+
+    outputs = inputs;
+    function.kernel(outputs.data(), SAMPLES, accuracy);
+
+    double max_absolute_error = 0.0;
+    double max_relative_error = 0.0;
+
+    for (std::size_t i = 0; i < SAMPLES; i++) {
+        const double expected = function.reference(inputs[i]);
+        const double error = std::abs(outputs[i] - expected);
+
+        max_absolute_error = std::max(max_absolute_error, error);
+
+        if (expected != 0.0) {
+            max_relative_error = std::max(max_relative_error, error / std::abs(expected));
+        }
+    }
+
+    double best = 1e9;
+
+    for (int i = 0; i < REPETITIONS; i++) {
+        outputs = inputs;
+
+        const auto start = std::chrono::steady_clock::now();
+        function.kernel(outputs.data(), SAMPLES, accuracy);
+        const auto end = std::chrono::steady_clock::now();
+
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / SAMPLES);
+    }
+
+    std::printf(
+        "%-8s %-8s %-11s %12.3e %12.3e %10.3f\n",
+        kernels::get_level_name(kernels::get_level()),
+        function.name,
+        kernels::get_accuracy_name(accuracy),
+        max_absolute_error,
+        max_relative_error,
+        best
+    );
+}
+
+int main() {
+    const Function functions[] = {
+        { "exp", -20.0, 20.0, kernels::exp, reference_exp },
+        { "tanh", -10.0, 10.0, kernels::tanh, reference_tanh },
+        { "sigmoid", -20.0, 20.0, kernels::sigmoid, reference_sigmoid }
+    };
+
+    std::printf("%-8s %-8s %-11s %12s %12s %10s\n", "level", "function", "accuracy", "abs error", "rel error", "ns/value");
+
+    for (kernels::Level level : { kernels::Level::Scalar, kernels::Level::Sse2, kernels::Level::Avx2, kernels::Level::Avx512 }) {
+        if (!kernels::force_level(level)) {
+            continue;
+        }
+
+        for (const Function& function : functions) {
+            for (kernels::Accuracy accuracy : { kernels::Accuracy::Exact, kernels::Accuracy::Polynomial, kernels::Accuracy::Table }) {
+                report(function, accuracy);
+            }
+        }
+    }
+}
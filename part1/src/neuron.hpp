@@ -7,10 +7,16 @@
 #include <cmath>
 #include <numbers>
 #include <cstring>
+#include <vector>
 
 /*
     It is assumed that Real is a IEEE-754 floating point type, which means that comparisons
     between whole numbers (0.0, 1.0, 2.0 etc.) work reliably.
+
+    Neuron<Real> takes its functions at runtime, as std::function. Neuron<Real, Input, Activation, Output>
+    takes them at compile time, as the policies from neuron::policy, so they are inlined:
+
+    neuron::Neuron<double, policy::Sum<double>, policy::Sigmoid<double>, policy::Identity<double>> neuron;
 */
 
 namespace neuron {
@@ -23,8 +29,14 @@ namespace neuron {
     template<typename Real>
     using OutputFunction = std::function<Real(Real)>;
 
+    // Marks the functions of a neuron as chosen at runtime
+    struct Runtime {};
+
+    template<typename Real, typename Input = Runtime, typename Activation = Runtime, typename Output = Runtime>
+    class Neuron;
+
     template<typename Real>
-    class Neuron {
+    class Neuron<Real, Runtime, Runtime, Runtime> {
     public:
         Neuron() = default;
         ~Neuron() = default;
@@ -210,4 +222,225 @@ namespace neuron {
             }
         }
     }
+
+    namespace policy {
+        // The input policies combine the products of the inputs and the weights one at a time, in order
+        template<typename Real>
+        struct Sum {
+            static constexpr Real INITIAL = static_cast<Real>(0.0);
+
+            static Real combine(Real result, Real x) {
+                return result + x;
+            }
+
+            Real operator()(const Real* inputs, const Real* weights, std::size_t size) const {
+                return input_function::sum(inputs, weights, size);
+            }
+        };
+
+        template<typename Real>
+        struct Product {
+            static constexpr Real INITIAL = static_cast<Real>(1.0);
+
+            static Real combine(Real result, Real x) {
+                return result * x;
+            }
+
+            Real operator()(const Real* inputs, const Real* weights, std::size_t size) const {
+                return input_function::product(inputs, weights, size);
+            }
+        };
+
+        template<typename Real>
+        struct Max {
+            static constexpr Real INITIAL = std::numeric_limits<Real>::min();
+
+            static Real combine(Real result, Real x) {
+                return std::max(result, x);
+            }
+
+            Real operator()(const Real* inputs, const Real* weights, std::size_t size) const {
+                return input_function::max(inputs, weights, size);
+            }
+        };
+
+        template<typename Real>
+        struct Min {
+            static constexpr Real INITIAL = std::numeric_limits<Real>::max();
+
+            static Real combine(Real result, Real x) {
+                return std::min(result, x);
+            }
+
+            Real operator()(const Real* inputs, const Real* weights, std::size_t size) const {
+                return input_function::min(inputs, weights, size);
+            }
+        };
+
+        template<typename Real>
+        struct Heaviside {
+            Real theta = static_cast<Real>(0.0);
+
+            Real operator()(Real x) const {
+                return activation_function::heaviside(x, theta);
+            }
+        };
+
+        template<typename Real>
+        struct Sigmoid {
+            Real theta = static_cast<Real>(0.0);
+            Real g = static_cast<Real>(1.0);
+
+            Real operator()(Real x) const {
+                return activation_function::sigmoid(x, theta, g);
+            }
+        };
+
+        template<typename Real>
+        struct Signum {
+            Real theta = static_cast<Real>(0.0);
+
+            Real operator()(Real x) const {
+                return activation_function::signum(x, theta);
+            }
+        };
+
+        template<typename Real>
+        struct Tanh {
+            Real theta = static_cast<Real>(0.0);
+            Real g = static_cast<Real>(1.0);
+
+            Real operator()(Real x) const {
+                return activation_function::tanh(x, theta, g);
+            }
+        };
+
+        template<typename Real>
+        struct Ramp {
+            Real a = static_cast<Real>(1.0);
+
+            Real operator()(Real x) const {
+                return activation_function::ramp(x, a);
+            }
+        };
+
+        template<typename Real>
+        struct Identity {
+            Real operator()(Real x) const {
+                return output_function::identity(x);
+            }
+        };
+
+        template<typename Real>
+        struct ClampBinary {
+            Real operator()(Real x) const {
+                return output_function::clamp_binary(x);
+            }
+        };
+
+        template<typename Real>
+        struct ClampBinary2 {
+            Real operator()(Real x) const {
+                return output_function::clamp_binary2(x);
+            }
+        };
+    }
+
+    template<typename Real, typename Input, typename Activation, typename Output>
+    class Neuron {
+    public:
+        Neuron() = default;
+
+        Neuron(const Input& input_function, const Activation& activation_function, const Output& output_function)
+            : input_function(input_function), activation_function(activation_function), output_function(output_function) {}
+
+        // New weights are zero
+        void setup_inputs(std::size_t n) {
+            weights.resize(n, static_cast<Real>(0.0));
+        }
+
+        Real* get_weights() {
+            return weights.data();
+        }
+
+        const Real* get_weights() const {
+            return weights.data();
+        }
+
+        std::size_t get_inputs() const {
+            return weights.size();
+        }
+
+        void set_input_function(const Input& input_function) {
+            this->input_function = input_function;
+        }
+
+        void set_activation_function(const Activation& activation_function) {
+            this->activation_function = activation_function;
+        }
+
+        void set_output_function(const Output& output_function) {
+            this->output_function = output_function;
+        }
+
+        bool is_valid() const {
+            return !weights.empty();
+        }
+
+        Real process(const Real* inputs) const {
+            return output_function(activation_function(input_function(inputs, weights.data(), weights.size())));
+        }
+
+        void process_in_steps(const Real* inputs, Real& global_input, Real& activation, Real& output) const {
+            global_input = input_function(inputs, weights.data(), weights.size());
+            activation = activation_function(global_input);
+            output = output_function(activation);
+        }
+
+        // Inputs are rows of get_inputs() values, one output for each row; same results as process()
+        void process_batch(const Real* inputs, std::size_t rows, Real* outputs) const;
+    private:
+        // Rows processed together by process_batch()
+        static constexpr std::size_t BLOCK = 4;
+
+        std::vector<Real> weights;
+
+        [[no_unique_address]] Input input_function;
+        [[no_unique_address]] Activation activation_function;
+        [[no_unique_address]] Output output_function;
+    };
+
+    template<typename Real, typename Input, typename Activation, typename Output>
+    void Neuron<Real, Input, Activation, Output>::process_batch(const Real* inputs, std::size_t rows, Real* outputs) const {
+        const std::size_t n = weights.size();
+
+        std::size_t begin = 0;
+
+        // Every weight is applied to a whole block of rows at once, in independent lanes
+        for (; begin + BLOCK <= rows; begin += BLOCK) {
+            const Real* block = inputs + begin * n;
+
+            Real results[BLOCK];
+
+            for (std::size_t r = 0; r < BLOCK; r++) {
+                results[r] = Input::INITIAL;
+            }
+
+            for (std::size_t i = 0; i < n; i++) {
+                const Real weight = weights[i];
+
+                for (std::size_t r = 0; r < BLOCK; r++) {
+                    results[r] = Input::combine(results[r], block[r * n + i] * weight);
+                }
+            }
+
+            for (std::size_t r = 0; r < BLOCK; r++) {
+                outputs[begin + r] = output_function(activation_function(results[r]));
+            }
+        }
+
+        for (; begin < rows; begin++) {
+            outputs[begin] = process(inputs + begin * n);
+        }
+    }
 }
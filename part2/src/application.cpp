@@ -19,6 +19,7 @@ void NnApplication::update() {
     ui::network_controls(network, built);
     ui::draw_network(network);
     ui::inputs_controls(inputs, n);
+    ui::timings_controls(network);
 }
 
 void NnApplication::dispose() {
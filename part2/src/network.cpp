@@ -6,11 +6,15 @@
 #include <functional>
 #include <utility>
 #include <cassert>
+#include <cstdint>
 #include <chrono>
-#include <iostream>
+#include <algorithm>
+
+#include <kernels/kernels.hpp>
 
 #include "network.hpp"
 #include "helpers.hpp"
+#include "timings.hpp"
 
 namespace neuron {
     double ActivationFunction::heaviside(const ActivationFunction* self, double x) {
@@ -35,43 +39,20 @@ namespace neuron {
 
     namespace functions {
         double sum(const double* inputs, const double* weights, std::size_t size) {
-            double result = 0.0;
-
-            for (std::size_t i = 0; i < size; i++) {
-                result += inputs[i] * weights[i];
-            }
-
-            return result;
+            return kernels::dot(inputs, weights, size);
         }
 
         double product(const double* inputs, const double* weights, std::size_t size) {
-            double result = 1.0;
-
-            for (std::size_t i = 0; i < size; i++) {
-                result *= inputs[i] * weights[i];
-            }
-
-            return result;
+            return kernels::product(inputs, weights, size);
         }
 
+        // The kernels start from -infinity and +infinity; keep the previous starting values
         double max(const double* inputs, const double* weights, std::size_t size) {
-            double result = std::numeric_limits<double>::min();
-
-            for (std::size_t i = 0; i < size; i++) {
-                result = std::max(result, inputs[i] * weights[i]);
-            }
-
-            return result;
+            return std::max(kernels::max(inputs, weights, size), std::numeric_limits<double>::min());
         }
 
         double min(const double* inputs, const double* weights, std::size_t size) {
-            double result = std::numeric_limits<double>::max();
-
-            for (std::size_t i = 0; i < size; i++) {
-                result = std::min(result, inputs[i] * weights[i]);
-            }
-
-            return result;
+            return std::min(kernels::min(inputs, weights, size), std::numeric_limits<double>::max());
         }
 
         double heaviside(double x, double theta) {
@@ -83,10 +64,9 @@ namespace neuron {
         }
 
         double sigmoid(double x, double theta, double g) {
-            static constexpr double e = std::numbers::e_v<double>;
             static constexpr double one = 1.0;
 
-            return one / (one + std::pow(e, -g * (x - theta)));
+            return one / (one + std::exp(-g * (x - theta)));
         }
 
         double signum(double x, double theta) {
@@ -98,12 +78,7 @@ namespace neuron {
         }
 
         double tanh(double x, double theta, double g) {
-            static constexpr double e = std::numbers::e_v<double>;
-
-            const double a = std::pow(e, g * (x - theta));
-            const double b = std::pow(e, -g * (x - theta));
-
-            return (a - b) / (a + b);
+            return std::tanh(g * (x - theta));
         }
 
         double ramp(double x, double a) {
@@ -137,61 +112,270 @@ namespace neuron {
         }
     }
 
+    // True, if the std::function holds exactly this plain function
+    template<typename Signature, typename Function>
+    static bool holds(const std::function<Signature>& function, Function* target) {
+        Function* const* pointer = function.template target<Function*>();
+
+        return pointer != nullptr && *pointer == target;
+    }
+
+    static InputKind resolve_input(const InputFunction& function) {
+        if (holds(function, functions::sum)) {
+            return InputKind::Sum;
+        } else if (holds(function, functions::product)) {
+            return InputKind::Product;
+        } else if (holds(function, functions::max)) {
+            return InputKind::Max;
+        } else if (holds(function, functions::min)) {
+            return InputKind::Min;
+        }
+
+        return InputKind::Custom;
+    }
+
+    static ActivationKind resolve_activation(const ActivationFunction::Function& function) {
+        if (holds(function, ActivationFunction::heaviside)) {
+            return ActivationKind::Heaviside;
+        } else if (holds(function, ActivationFunction::sigmoid)) {
+            return ActivationKind::Sigmoid;
+        } else if (holds(function, ActivationFunction::signum)) {
+            return ActivationKind::Signum;
+        } else if (holds(function, ActivationFunction::tanh)) {
+            return ActivationKind::Tanh;
+        } else if (holds(function, ActivationFunction::ramp)) {
+            return ActivationKind::Ramp;
+        }
+
+        return ActivationKind::Custom;
+    }
+
+    static OutputKind resolve_output(const OutputFunction& function) {
+        if (holds(function, functions::identity)) {
+            return OutputKind::Identity;
+        } else if (holds(function, functions::binary)) {
+            return OutputKind::Binary;
+        } else if (holds(function, functions::binary2)) {
+            return OutputKind::Binary2;
+        }
+
+        return OutputKind::Custom;
+    }
+
+    template<ActivationKind Activation>
+    static double activate(const ActivationFunction& function, double x) {
+        if constexpr (Activation == ActivationKind::Heaviside) {
+            return functions::heaviside(x, function.theta);
+        } else if constexpr (Activation == ActivationKind::Sigmoid) {
+            return functions::sigmoid(x, function.theta, function.g);
+        } else if constexpr (Activation == ActivationKind::Signum) {
+            return functions::signum(x, function.theta);
+        } else if constexpr (Activation == ActivationKind::Tanh) {
+            return functions::tanh(x, function.theta, function.g);
+        } else if constexpr (Activation == ActivationKind::Ramp) {
+            return functions::ramp(x, function.a);
+        } else {
+            return function(x);
+        }
+    }
+
+    template<OutputKind Output>
+    static double output(const OutputFunction& function, double x) {
+        if constexpr (Output == OutputKind::Identity) {
+            return functions::identity(x);
+        } else if constexpr (Output == OutputKind::Binary) {
+            return functions::binary(x);
+        } else if constexpr (Output == OutputKind::Binary2) {
+            return functions::binary2(x);
+        } else {
+            return function(x);
+        }
+    }
+
+    // One loop over the neurons of a layer with both functions inlined, unless they are custom
+    template<ActivationKind Activation, OutputKind Output>
+    static bool activate_layer(Layer& layer, double* outputs, bool all) {
+        bool changed = false;
+
+        for (std::size_t j = 0; j < layer.neurons.size(); j++) {
+            Neuron& neuron = layer.neurons[j];
+
+            if (!all && !neuron.dirty) {
+                continue;
+            }
+
+            const double previous_output = neuron.result.output;
+
+            neuron.result.activation = activate<Activation>(layer.activation_function, neuron.result.global_input);
+            neuron.result.output = output<Output>(layer.output_function, neuron.result.activation);
+            neuron.dirty = false;
+
+            changed |= neuron.result.output != previous_output;
+
+            if (outputs != nullptr) {
+                outputs[j] = neuron.result.output;
+            }
+        }
+
+        return changed;
+    }
+
+    // Custom functions may depend on anything, so they are always computed
+    static bool is_custom(const Layer& layer) {
+        return (
+            layer.plan.input == InputKind::Custom ||
+            layer.plan.activation == ActivationKind::Custom ||
+            layer.plan.output == OutputKind::Custom
+        );
+    }
+
+    static bool constants_changed(const Layer& layer) {
+        return (
+            layer.activation_function.theta != layer.computed.theta ||
+            layer.activation_function.g != layer.computed.g ||
+            layer.activation_function.a != layer.computed.a
+        );
+    }
+
+    static bool any_dirty(const Layer& layer) {
+        return std::any_of(layer.neurons.begin(), layer.neurons.end(), [](const Neuron& neuron) {
+            return neuron.dirty;
+        });
+    }
+
+    template<ActivationKind Activation>
+    static Layer::Kernel resolve_kernel(OutputKind output) {
+        switch (output) {
+            case OutputKind::Identity:
+                return activate_layer<Activation, OutputKind::Identity>;
+            case OutputKind::Binary:
+                return activate_layer<Activation, OutputKind::Binary>;
+            case OutputKind::Binary2:
+                return activate_layer<Activation, OutputKind::Binary2>;
+            case OutputKind::Custom:
+                break;
+        }
+
+        return activate_layer<Activation, OutputKind::Custom>;
+    }
+
+    static Layer::Kernel resolve_kernel(ActivationKind activation, OutputKind output) {
+        switch (activation) {
+            case ActivationKind::Heaviside:
+                return resolve_kernel<ActivationKind::Heaviside>(output);
+            case ActivationKind::Sigmoid:
+                return resolve_kernel<ActivationKind::Sigmoid>(output);
+            case ActivationKind::Signum:
+                return resolve_kernel<ActivationKind::Signum>(output);
+            case ActivationKind::Tanh:
+                return resolve_kernel<ActivationKind::Tanh>(output);
+            case ActivationKind::Ramp:
+                return resolve_kernel<ActivationKind::Ramp>(output);
+            case ActivationKind::Custom:
+                break;
+        }
+
+        return resolve_kernel<ActivationKind::Custom>(output);
+    }
+
     void Layer::set_input_function(const InputFunction& input_function) {
         this->input_function = input_function;
+
+        compile();
     }
 
     void Layer::set_activation_function(const ActivationFunction::Function& activation_function) {
         this->activation_function.set(activation_function);
+
+        compile();
     }
 
     void Layer::set_output_function(const OutputFunction& output_function) {
         this->output_function = output_function;
+
+        compile();
     }
 
-    void Network::run(const double* inputs, double* outputs) {
-        const auto start = std::chrono::steady_clock::now();
+    void Layer::compile() {
+        plan.input = resolve_input(input_function);
+        plan.activation = resolve_activation(activation_function.get());
+        plan.output = resolve_output(output_function);
+        plan.kernel = resolve_kernel(plan.activation, plan.output);
+
+        dirty = true;
+    }
 
-        std::size_t i = 0;
+    // Without timings the function is just called; there is no clock read and no branch inside
+    template<bool Timed, typename Function>
+    static void measure(Histogram& histogram, const Function& function) {
+        if constexpr (Timed) {
+            const auto start = std::chrono::steady_clock::now();
 
-        auto& layer = hidden_layers[i];
+            function();
 
-        for (Neuron& neuron : layer.neurons) {
-            process_neuron(neuron, layer, inputs, input_neurons);
-        }
+            const auto end = std::chrono::steady_clock::now();
 
-        std::size_t current_n = 0;
-        double* current_inputs = nullptr;
-        allocate_current_inputs(&current_inputs, &current_n, hidden_layers[i].neurons);
+            histogram.add(static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+        } else {
+            function();
+        }
+    }
 
-        i++;
+    void Network::run(const double* inputs, double* outputs) {
+        if (timings.enabled) {
+            forward<true>(inputs, outputs);
+        } else {
+            forward<false>(inputs, outputs);
+        }
+    }
 
-        for (; i < hidden_layers.size(); i++) {
-            auto& layer = hidden_layers[i];
+    template<bool Timed>
+    void Network::forward(const double* inputs, double* outputs) {
+        measure<Timed>(timings.run, [&]() {
+            // A changed input affects every neuron of the first layer
+            bool changed = !std::equal(inputs, inputs + input_neurons, workspace.inputs.begin());
 
-            for (Neuron& neuron : layer.neurons) {
-                process_neuron(neuron, layer, current_inputs, current_n);
+            if (changed) {
+                std::copy(inputs, inputs + input_neurons, workspace.inputs.begin());
             }
 
-            allocate_current_inputs(&current_inputs, &current_n, hidden_layers[i].neurons);
-        }
+            const double* current_inputs = workspace.inputs.data();
+            std::size_t current_n = input_neurons;
 
-        for (Neuron& neuron : output_layer.neurons) {
-            process_neuron(neuron, output_layer, current_inputs, current_n);
-        }
+            // Then every neuron of a layer is affected by a changed output of the previous one
+            const auto process = [&](Layer& layer, double* layer_outputs, Histogram& histogram) {
+                const bool all = changed || layer.dirty || constants_changed(layer) || is_custom(layer);
+
+                if (!all && !any_dirty(layer)) {
+                    changed = false;
+                    return;
+                }
 
-        // Delete last allocation
-        delete[] current_inputs;
+                measure<Timed>(histogram, [&]() {
+                    changed = process_layer(layer, current_inputs, current_n, layer_outputs, all);
+                });
 
-        if (outputs != nullptr) {
-            for (std::size_t j = 0; j < output_layer.neurons.size(); j++) {
-                outputs[j] = output_layer.neurons[j].result.output;
+                layer.dirty = false;
+                layer.computed.theta = layer.activation_function.theta;
+                layer.computed.g = layer.activation_function.g;
+                layer.computed.a = layer.activation_function.a;
+            };
+
+            for (std::size_t i = 0; i < hidden_layers.size(); i++) {
+                process(hidden_layers[i], workspace.outputs[i].data(), timings.layers[i]);
+
+                current_inputs = workspace.outputs[i].data();
+                current_n = hidden_layers[i].neurons.size();
             }
-        }
 
-        const auto end = std::chrono::steady_clock::now();
+            process(output_layer, nullptr, timings.layers.back());
 
-        std::cout << std::chrono::duration<double>(end - start).count() << '\n';
+            if (outputs != nullptr) {
+                for (std::size_t j = 0; j < output_layer.neurons.size(); j++) {
+                    outputs[j] = output_layer.neurons[j].result.output;
+                }
+            }
+        });
     }
 
     void Network::setup(std::size_t input_neurons, std::size_t output_neurons, HiddenLayers&& hidden_layers) {
@@ -212,13 +396,35 @@ namespace neuron {
             this->hidden_layers.push_back(std::move(layer));
         }
 
+        workspace.inputs.resize(input_neurons);
+
+        for (const Layer& layer : this->hidden_layers) {
+            workspace.outputs.emplace_back(layer.neurons.size());
+        }
+
+        timings.layers.resize(this->hidden_layers.size() + 1);
+
         initialize_neurons();
+        compile();
     }
 
     void Network::clear() {
         input_neurons = 0;
         output_layer = {};
         hidden_layers.clear();
+        workspace = {};
+
+        // Keep measuring, if it was enabled
+        timings.run.clear();
+        timings.layers.clear();
+    }
+
+    void Network::compile() {
+        for (Layer& layer : hidden_layers) {
+            layer.compile();
+        }
+
+        output_layer.compile();
     }
 
     void Network::initialize_neurons() {
@@ -227,6 +433,7 @@ namespace neuron {
         for (Layer& layer : hidden_layers) {
             for (Neuron& neuron : layer.neurons) {
                 reallocate_double_array(&neuron.weights, &neuron.n, current_inputs);
+                neuron.dirty = true;
             }
 
             current_inputs = layer.neurons.size();
@@ -234,23 +441,39 @@ namespace neuron {
 
         for (Neuron& neuron : output_layer.neurons) {
             reallocate_double_array(&neuron.weights, &neuron.n, current_inputs);
+            neuron.dirty = true;
         }
     }
 
-    void Network::allocate_current_inputs(double** inputs, std::size_t* n, const std::vector<Neuron>& neurons) {
-        delete[] *inputs;
-
-        *n = neurons.size();
-        *inputs = new double[*n];
+    bool Network::process_layer(Layer& layer, const double* inputs, std::size_t n, double* outputs, bool all) {
+        assert(layer.plan.kernel != nullptr);
 
-        for (std::size_t i = 0; i < *n; i++) {
-            (*inputs)[i] = neurons[i].result.output;
+        const auto global_inputs = [&](const auto& function) {
+            for (Neuron& neuron : layer.neurons) {
+                if (all || neuron.dirty) {
+                    neuron.result.global_input = function(inputs, neuron.weights, n);
+                }
+            }
+        };
+
+        switch (layer.plan.input) {
+            case InputKind::Sum:
+                global_inputs(functions::sum);
+                break;
+            case InputKind::Product:
+                global_inputs(functions::product);
+                break;
+            case InputKind::Max:
+                global_inputs(functions::max);
+                break;
+            case InputKind::Min:
+                global_inputs(functions::min);
+                break;
+            case InputKind::Custom:
+                global_inputs(layer.input_function);
+                break;
         }
-    }
 
-    void Network::process_neuron(Neuron& neuron, const Layer& layer, const double* inputs, std::size_t n) {
-        neuron.result.global_input = layer.input_function(inputs, neuron.weights, n);
-        neuron.result.activation = layer.activation_function(neuron.result.global_input);
-        neuron.result.output = layer.output_function(neuron.result.activation);
+        return layer.plan.kernel(layer, outputs, all);
     }
 }
@@ -7,6 +7,8 @@
 #include <numbers>
 #include <functional>
 
+#include "timings.hpp"
+
 namespace neuron {
     using InputFunction = std::function<double(const double*, const double*, std::size_t)>;
     using OutputFunction = std::function<double(double)>;
@@ -31,6 +33,10 @@ namespace neuron {
             this->function = function;
         }
 
+        const Function& get() const {
+            return function;
+        }
+
         static double heaviside(const ActivationFunction* self, double x);
         static double sigmoid(const ActivationFunction* self, double x);
         static double signum(const ActivationFunction* self, double x);
@@ -61,6 +67,9 @@ namespace neuron {
         double* weights = nullptr;
         std::size_t n = 0;
 
+        // Set it after changing the weights, so that the next run computes the neuron again
+        bool dirty = true;
+
         struct {
             double global_input = 0.0f;
             double activation = 0.0f;
@@ -68,18 +77,68 @@ namespace neuron {
         } result;
     };
 
+    // The functions known at compile time; anything else is a user-supplied callable
+    enum class InputKind {
+        Sum,
+        Product,
+        Max,
+        Min,
+        Custom
+    };
+
+    enum class ActivationKind {
+        Heaviside,
+        Sigmoid,
+        Signum,
+        Tanh,
+        Ramp,
+        Custom
+    };
+
+    enum class OutputKind {
+        Identity,
+        Binary,
+        Binary2,
+        Custom
+    };
+
     class Network;
 
     struct Layer {
+        // Activation and output of every neuron (or only the dirty ones), after the global inputs;
+        // outputs may be null; return true, if any output is different than before
+        using Kernel = bool(*)(Layer& layer, double* outputs, bool all);
+
         void set_input_function(const InputFunction& input_function);
         void set_activation_function(const ActivationFunction::Function& activation_function);
         void set_output_function(const OutputFunction& output_function);
 
+        // Resolve the functions to a plan; the setters do it, assigning the members directly doesn't
+        void compile();
+
         std::vector<Neuron> neurons;
 
         InputFunction input_function = functions::sum;
         ActivationFunction activation_function = ActivationFunction(ActivationFunction::sigmoid);
         OutputFunction output_function = functions::identity;
+
+        // Execution plan; the std::function members are only called for the custom kinds
+        struct {
+            InputKind input = InputKind::Sum;
+            ActivationKind activation = ActivationKind::Sigmoid;
+            OutputKind output = OutputKind::Identity;
+            Kernel kernel = nullptr;
+        } plan;
+
+        // Set when all the neurons must be computed again; changing the functions sets it
+        bool dirty = true;
+
+        // Constants of the last run; the network compares them, so they can be changed directly
+        struct {
+            double theta = 0.0;
+            double g = 0.0;
+            double a = 0.0;
+        } computed;
     };
 
     struct Network {
@@ -87,16 +146,31 @@ namespace neuron {
             std::vector<std::size_t> layers;
         };
 
+        // Inputs and outputs of the hidden layers of the last run, sized once in setup(); they are kept,
+        // so that a run computes only the neurons affected by what changed since the last one
+        struct Workspace {
+            std::vector<double> inputs;
+            std::vector<std::vector<double>> outputs;
+        };
+
+        // Compute only the neurons that depend on something changed; nothing, if nothing changed
         void run(const double* inputs, double* outputs);
         void setup(std::size_t input_neurons, std::size_t output_neurons, HiddenLayers&& hidden_layers);
         void clear();
 
+        // Compile the plans of all the layers again, after assigning their functions directly
+        void compile();
+
         void initialize_neurons();
-        void allocate_current_inputs(double** inputs, std::size_t* n, const std::vector<Neuron>& neurons);
-        void process_neuron(Neuron& neuron, const Layer& layer, const double* inputs, std::size_t n);
+        bool process_layer(Layer& layer, const double* inputs, std::size_t n, double* outputs, bool all);
+
+        template<bool Timed>
+        void forward(const double* inputs, double* outputs);
 
         std::size_t input_neurons {};
         Layer output_layer;
         std::vector<Layer> hidden_layers;
+        Workspace workspace;
+        Timings timings;
     };
 }
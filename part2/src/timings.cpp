@@ -0,0 +1,78 @@
+#include <cstddef>
+#include <cstdint>
+#include <bit>
+#include <cmath>
+
+#include "timings.hpp"
+
+namespace neuron {
+    void Histogram::add(std::uint64_t nanoseconds) {
+        buckets[index(nanoseconds)]++;
+        total++;
+        sum += nanoseconds;
+    }
+
+    void Histogram::clear() {
+        buckets = {};
+        total = 0;
+        sum = 0;
+    }
+
+    double Histogram::percentile(double fraction) const {
+        if (total == 0) {
+            return 0.0;
+        }
+
+        const std::size_t rank = static_cast<std::size_t>(std::ceil(fraction * static_cast<double>(total)));
+        std::size_t seen = 0;
+
+        for (std::size_t i = 0; i < BUCKETS; i++) {
+            seen += buckets[i];
+
+            if (seen >= rank && seen > 0) {
+                return static_cast<double>(lower_bound(i)) * 1e-9;
+            }
+        }
+
+        return static_cast<double>(lower_bound(BUCKETS - 1)) * 1e-9;
+    }
+
+    double Histogram::mean() const {
+        if (total == 0) {
+            return 0.0;
+        }
+
+        return static_cast<double>(sum) / static_cast<double>(total) * 1e-9;
+    }
+
+    std::size_t Histogram::index(std::uint64_t nanoseconds) {
+        // Exact below SUB_BUCKETS, then SUB_BUCKETS buckets for every power of two
+        if (nanoseconds < SUB_BUCKETS) {
+            return static_cast<std::size_t>(nanoseconds);
+        }
+
+        const std::size_t exponent = static_cast<std::size_t>(std::bit_width(nanoseconds)) - 1;
+        const std::size_t sub_bucket = static_cast<std::size_t>(nanoseconds >> (exponent - 4)) & (SUB_BUCKETS - 1);
+
+        return (exponent - 3) * SUB_BUCKETS + sub_bucket;
+    }
+
+    std::uint64_t Histogram::lower_bound(std::size_t index) {
+        if (index < SUB_BUCKETS) {
+            return index;
+        }
+
+        const std::size_t exponent = index / SUB_BUCKETS + 3;
+        const std::size_t sub_bucket = index % SUB_BUCKETS;
+
+        return static_cast<std::uint64_t>(SUB_BUCKETS + sub_bucket) << (exponent - 4);
+    }
+
+    void Timings::clear() {
+        run.clear();
+
+        for (Histogram& histogram : layers) {
+            histogram.clear();
+        }
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace neuron {
+    // Durations in nanoseconds, in buckets about 6% wide; memory and cost of adding are constant
+    class Histogram {
+    public:
+        void add(std::uint64_t nanoseconds);
+        void clear();
+
+        // Lower bound of the bucket holding the fraction of the samples, in seconds; 0.0 for no samples
+        double percentile(double fraction) const;
+
+        double mean() const;
+
+        std::size_t count() const {
+            return total;
+        }
+    private:
+        static constexpr std::size_t SUB_BUCKETS = 16;
+        static constexpr std::size_t BUCKETS = (64 - 3) * SUB_BUCKETS;
+
+        static std::size_t index(std::uint64_t nanoseconds);
+        static std::uint64_t lower_bound(std::size_t index);
+
+        std::array<std::uint32_t, BUCKETS> buckets {};
+        std::size_t total = 0;
+        std::uint64_t sum = 0;
+    };
+
+    // Durations of Network::run and of every layer; nothing is measured while disabled
+    struct Timings {
+        void clear();
+
+        bool enabled = false;
+
+        Histogram run;
+        std::vector<Histogram> layers;  // Hidden layers, then the output layer
+    };
+}
@@ -123,7 +123,9 @@ namespace ui {
             for (std::size_t i = 0; i < neuron->n; i++) {
                 ImGui::PushID(i);
 
-                ImGui::InputDouble("##", neuron->weights + i, 0.01);
+                if (ImGui::InputDouble("##", neuron->weights + i, 0.01)) {
+                    neuron->dirty = true;
+                }
                 ImGui::SameLine();
                 ImGui::Text("%lu", i);
 
@@ -436,6 +438,59 @@ namespace ui {
         ImGui::End();
     }
 
+    static void histogram_row(const char* name, const neuron::Histogram& histogram) {
+        ImGui::TableNextColumn();
+        ImGui::Text("%s", name);
+        ImGui::TableNextColumn();
+        ImGui::Text("%lu", histogram.count());
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", histogram.mean() * 1e6);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", histogram.percentile(0.5) * 1e6);
+        ImGui::TableNextColumn();
+        ImGui::Text("%.2f", histogram.percentile(0.99) * 1e6);
+    }
+
+    void timings_controls(neuron::Network& network) {
+        if (ImGui::Begin("Timings")) {
+            ImGui::Checkbox("Measure", &network.timings.enabled);
+            ImGui::SameLine();
+
+            if (ImGui::Button("Clear")) {
+                network.timings.clear();
+            }
+
+            ImGui::Spacing();
+
+            if (ImGui::BeginTable("Timings", 5, ImGuiTableFlags_Borders)) {
+                ImGui::TableSetupColumn("Layer");
+                ImGui::TableSetupColumn("Runs");
+                ImGui::TableSetupColumn("Mean us");
+                ImGui::TableSetupColumn("p50 us");
+                ImGui::TableSetupColumn("p99 us");
+                ImGui::TableHeadersRow();
+
+                for (std::size_t i = 0; i < network.timings.layers.size(); i++) {
+                    char name[32];
+
+                    if (i + 1 == network.timings.layers.size()) {
+                        std::snprintf(name, sizeof(name), "Output");
+                    } else {
+                        std::snprintf(name, sizeof(name), "Hidden %lu", i);
+                    }
+
+                    histogram_row(name, network.timings.layers[i]);
+                }
+
+                histogram_row("Whole network", network.timings.run);
+
+                ImGui::EndTable();
+            }
+        }
+
+        ImGui::End();
+    }
+
     void inputs_controls(double* inputs, std::size_t n) {
         if (ImGui::Begin("Inputs Controls")) {
             ImGui::Text("Inputs");
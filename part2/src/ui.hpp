@@ -9,4 +9,5 @@ namespace ui {
     bool build_network(neuron::Network& network, double** inputs, std::size_t* n);
     void network_controls(neuron::Network& network, bool reset);
     void inputs_controls(double* inputs, std::size_t n);
+    void timings_controls(neuron::Network& network);
 }
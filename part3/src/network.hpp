@@ -10,18 +10,14 @@
 #include <cassert>
 #include <cmath>
 
+#include <kernels/kernels.hpp>
+
 #include "helpers.hpp"
 
 namespace network {
     namespace functions {
-        constexpr double sum(const double* inputs, const double* weights, std::size_t size) {
-            double result = 0.0;
-
-            for (std::size_t i = 0; i < size; i++) {
-                result += inputs[i] * weights[i];
-            }
-
-            return result;
+        inline double sum(const double* inputs, const double* weights, std::size_t size) {
+            return kernels::dot(inputs, weights, size);
         }
 
         constexpr double sigmoid(double x) {
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <vector>
+#include <deque>
+#include <cstddef>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#include <cassert>
+
+#include "network.hpp"
+
+/*
+    Groups the requests of many threads into batches for a single worker thread.
+
+    A batch is closed when its oldest request has waited for the maximum time, or earlier when it
+    is as big as the previous batch, which estimates the number of callers at the moment. So a lone
+    caller is served immediately, a steady group of callers is served as soon as all of them have
+    asked again, and the batches grow up to the maximum size as more requests queue up.
+*/
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+class Batcher {
+public:
+    Batcher(const network::Network<Real, Inputs, Outputs>& network, std::size_t max_batch_size, std::chrono::microseconds max_wait)
+        : network(network), max_batch_size(max_batch_size), max_wait(max_wait) {
+        assert(max_batch_size > 0);
+
+        worker = std::thread([this]() {
+            work();
+        });
+    }
+
+    ~Batcher() {
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+            stopping = true;
+        }
+
+        available.notify_all();
+        worker.join();
+    }
+
+    Batcher(const Batcher&) = delete;
+    Batcher& operator=(const Batcher&) = delete;
+
+    // Block until the outputs are ready; return false if it is shutting down
+    bool predict(const Real* inputs, Real* outputs);
+private:
+    struct Request {
+        const Real* inputs = nullptr;
+        Real* outputs = nullptr;
+        std::chrono::steady_clock::time_point arrival;
+        std::promise<void> done;
+    };
+
+    void work();
+
+    const network::Network<Real, Inputs, Outputs>& network;
+    std::size_t max_batch_size = 1;
+    std::chrono::microseconds max_wait {};
+
+    std::deque<Request*> queue;
+    bool stopping = false;
+    std::mutex mutex;
+    std::condition_variable available;
+    std::thread worker;
+};
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+bool Batcher<Real, Inputs, Outputs>::predict(const Real* inputs, Real* outputs) {
+    Request request;
+    request.inputs = inputs;
+    request.outputs = outputs;
+    request.arrival = std::chrono::steady_clock::now();
+
+    std::future<void> done = request.done.get_future();
+
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+
+        if (stopping) {
+            return false;
+        }
+
+        queue.push_back(&request);
+    }
+
+    available.notify_one();
+    done.wait();
+
+    return true;
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Batcher<Real, Inputs, Outputs>::work() {
+    network::Workspace<Real> workspace = network.create_workspace();
+    std::vector<Real> inputs(max_batch_size * Inputs);
+    std::vector<Real> outputs(max_batch_size * Outputs);
+    std::vector<Request*> batch;
+    batch.reserve(max_batch_size);
+
+    std::size_t expected_batch_size = 1;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+
+            available.wait(lock, [this]() {
+                return stopping || !queue.empty();
+            });
+
+            // Serve what is left before stopping
+            if (queue.empty()) {
+                return;
+            }
+
+            available.wait_until(lock, queue.front()->arrival + max_wait, [this, expected_batch_size]() {
+                return stopping || queue.size() >= expected_batch_size;
+            });
+
+            while (!queue.empty() && batch.size() < max_batch_size) {
+                batch.push_back(queue.front());
+                queue.pop_front();
+            }
+        }
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            for (std::size_t j = 0; j < Inputs; j++) {
+                inputs[i * Inputs + j] = batch[i]->inputs[j];
+            }
+        }
+
+        network.run_batch(inputs.data(), batch.size(), outputs.data(), workspace);
+
+        for (std::size_t i = 0; i < batch.size(); i++) {
+            for (std::size_t j = 0; j < Outputs; j++) {
+                batch[i]->outputs[j] = outputs[i * Outputs + j];
+            }
+
+            batch[i]->done.set_value();
+        }
+
+        expected_batch_size = batch.size();
+        batch.clear();
+    }
+}
@@ -0,0 +1,112 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <csignal>
+#include <chrono>
+#include <string>
+#include <array>
+#include <span>
+
+#include "network.hpp"
+#include "helpers.hpp"
+#include "model_file.hpp"
+#include "mapped_file.hpp"
+#include "precision.hpp"
+#include "thread_pool.hpp"
+#include "batcher.hpp"
+#include "server.hpp"
+
+/*
+    Headless prediction server for a network saved by nn3b.
+
+    nn3b_daemon <model> [socket] [max batch size] [max wait in microseconds]
+
+    A request is the 18 attributes of a company, not normalized, as doubles in the order of the
+    columns X1 to X18 of the dataset. The response is the output of the network as one double;
+    1.0 means alive.
+*/
+
+static constexpr const char* DEFAULT_SOCKET_PATH = "/tmp/nn3b.sock";
+static constexpr std::size_t DEFAULT_MAX_BATCH_SIZE = 64;
+static constexpr long DEFAULT_MAX_WAIT = 200;
+
+static Server* server_instance = nullptr;
+
+static void handle_signal(int) {
+    if (server_instance != nullptr) {
+        server_instance->stop();
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <model> [socket] [max batch size] [max wait in microseconds]\n", argv[0]);
+        return 1;
+    }
+
+    const std::string model_file_name {argv[1]};
+    const std::string socket_path {argc > 2 ? argv[2] : DEFAULT_SOCKET_PATH};
+    const std::size_t max_batch_size {argc > 3 ? std::strtoul(argv[3], nullptr, 10) : DEFAULT_MAX_BATCH_SIZE};
+    const long max_wait {argc > 4 ? std::strtol(argv[4], nullptr, 10) : DEFAULT_MAX_WAIT};
+
+    if (max_batch_size == 0 || max_wait < 0) {
+        std::fprintf(stderr, "Invalid batch size or wait time\n");
+        return 1;
+    }
+
+    // The weights stay in the mapping, so it is declared first and outlives the network
+    MappedFile model;
+    network::Network<Precision, 18, 1> network;
+    Normalization normalization;
+
+    if (!model.open(model_file_name) || !network::load(network, model, &normalization)) {
+        std::fprintf(stderr, "Could not load model %s\n", model_file_name.c_str());
+        return 1;
+    }
+
+    ThreadPool thread_pool;
+    network.parallelism.pool = &thread_pool;
+
+    Batcher<Precision, 18, 1> batcher {network, max_batch_size, std::chrono::microseconds(max_wait)};
+
+    Server server {socket_path, 18, 1, [&batcher, &normalization](const double* request, double* response) {
+        std::array<Precision, 18> inputs {};
+        Precision outputs[1];
+
+        for (std::size_t i {0}; i < 18; i++) {
+            inputs[i] = static_cast<Precision>(request[i]);
+        }
+
+        normalize_features(std::span<Precision>(inputs), normalization);
+
+        if (!batcher.predict(inputs.data(), outputs)) {
+            return false;
+        }
+
+        response[0] = outputs[0];
+
+        return true;
+    }};
+
+    if (!server.listen()) {
+        std::fprintf(stderr, "Could not listen on %s\n", socket_path.c_str());
+        return 1;
+    }
+
+    server_instance = &server;
+
+    struct sigaction action {};
+    action.sa_handler = handle_signal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, nullptr);
+    sigaction(SIGTERM, &action, nullptr);
+
+    std::printf("Serving %s on %s, batches of at most %zu, waiting at most %ld us\n", model_file_name.c_str(), socket_path.c_str(), max_batch_size, max_wait);
+    std::fflush(stdout);
+
+    server.run();
+
+    server_instance = nullptr;
+
+    return 0;
+}
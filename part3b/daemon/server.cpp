@@ -0,0 +1,251 @@
+#include <cstddef>
+#include <cstring>
+#include <cerrno>
+#include <vector>
+#include <string>
+#include <utility>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "server.hpp"
+
+static bool read_all(int file_descriptor, void* buffer, std::size_t size) {
+    char* bytes {static_cast<char*>(buffer)};
+
+    while (size > 0) {
+        const ssize_t result {::read(file_descriptor, bytes, size)};
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            return false;
+        }
+
+        bytes += result;
+        size -= static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+static bool write_all(int file_descriptor, const void* buffer, std::size_t size) {
+    const char* bytes {static_cast<const char*>(buffer)};
+
+    while (size > 0) {
+        // Without a signal, if the client went away
+        const ssize_t result {::send(file_descriptor, bytes, size, MSG_NOSIGNAL)};
+
+        if (result < 0 && errno == EINTR) {
+            continue;
+        }
+
+        if (result <= 0) {
+            return false;
+        }
+
+        bytes += result;
+        size -= static_cast<std::size_t>(result);
+    }
+
+    return true;
+}
+
+// Remove the socket file a previous instance left behind, but nothing else at that path
+static bool remove_stale_socket(const sockaddr_un& address) {
+    struct stat status {};
+
+    if (::lstat(address.sun_path, &status) < 0) {
+        return errno == ENOENT;
+    }
+
+    if (!S_ISSOCK(status.st_mode)) {
+        return false;
+    }
+
+    // A socket that still accepts connections belongs to a running server
+    const int file_descriptor {::socket(AF_UNIX, SOCK_STREAM, 0)};
+
+    if (file_descriptor < 0) {
+        return false;
+    }
+
+    const int result {::connect(file_descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address))};
+    const int error {errno};
+
+    ::close(file_descriptor);
+
+    if (result == 0 || error != ECONNREFUSED) {
+        return false;
+    }
+
+    return ::unlink(address.sun_path) == 0 || errno == ENOENT;
+}
+
+Server::~Server() {
+    stop();
+    close_connections();
+
+    if (listening_file_descriptor >= 0) {
+        ::close(listening_file_descriptor);
+    }
+
+    remove_socket();
+}
+
+bool Server::listen() {
+    sockaddr_un address {};
+    address.sun_family = AF_UNIX;
+
+    if (socket_path.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+
+    std::memcpy(address.sun_path, socket_path.c_str(), socket_path.size() + 1);
+
+    listening_file_descriptor = ::socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if (listening_file_descriptor < 0) {
+        return false;
+    }
+
+    if (!remove_stale_socket(address)) {
+        ::close(listening_file_descriptor);
+        listening_file_descriptor = -1;
+
+        return false;
+    }
+
+    if (::bind(listening_file_descriptor, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) < 0) {
+        ::close(listening_file_descriptor);
+        listening_file_descriptor = -1;
+
+        return false;
+    }
+
+    // Remember which file is ours, so that only it is removed later
+    struct stat status {};
+
+    if (::lstat(socket_path.c_str(), &status) == 0) {
+        created_socket = true;
+        socket_device = status.st_dev;
+        socket_inode = status.st_ino;
+    }
+
+    if (::listen(listening_file_descriptor, SOMAXCONN) < 0) {
+        ::close(listening_file_descriptor);
+        listening_file_descriptor = -1;
+        remove_socket();
+
+        return false;
+    }
+
+    running = true;
+
+    return true;
+}
+
+void Server::remove_socket() {
+    if (!created_socket) {
+        return;
+    }
+
+    created_socket = false;
+
+    // Another server may have replaced the file in the meantime
+    struct stat status {};
+
+    if (::lstat(socket_path.c_str(), &status) == 0 && status.st_dev == socket_device && status.st_ino == socket_inode) {
+        ::unlink(socket_path.c_str());
+    }
+}
+
+void Server::run() {
+    while (running) {
+        const int file_descriptor {::accept(listening_file_descriptor, nullptr, nullptr)};
+
+        if (file_descriptor < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+
+            break;
+        }
+
+        join_finished_connections();
+
+        std::lock_guard<std::mutex> lock {connections_mutex};
+
+        Connection& connection {connections.emplace_back()};
+        connection.file_descriptor = file_descriptor;
+        connection.thread = std::thread([this, &connection]() {
+            serve(connection);
+        });
+    }
+
+    close_connections();
+}
+
+void Server::stop() {
+    // Only async-signal-safe calls; shutting down the socket wakes up accept()
+    running = false;
+
+    if (listening_file_descriptor >= 0) {
+        ::shutdown(listening_file_descriptor, SHUT_RDWR);
+    }
+}
+
+void Server::serve(Connection& connection) {
+    std::vector<double> request(request_size);
+    std::vector<double> response(response_size);
+
+    while (running) {
+        if (!read_all(connection.file_descriptor, request.data(), request.size() * sizeof(double))) {
+            break;
+        }
+
+        if (!handler(request.data(), response.data())) {
+            break;
+        }
+
+        if (!write_all(connection.file_descriptor, response.data(), response.size() * sizeof(double))) {
+            break;
+        }
+    }
+
+    connection.finished = true;
+}
+
+void Server::join_finished_connections() {
+    std::lock_guard<std::mutex> lock {connections_mutex};
+
+    for (auto iter {connections.begin()}; iter != connections.end();) {
+        if (iter->finished) {
+            iter->thread.join();
+            ::close(iter->file_descriptor);
+            iter = connections.erase(iter);
+        } else {
+            iter++;
+        }
+    }
+}
+
+void Server::close_connections() {
+    std::lock_guard<std::mutex> lock {connections_mutex};
+
+    // Wake up the threads blocked in read()
+    for (Connection& connection : connections) {
+        ::shutdown(connection.file_descriptor, SHUT_RDWR);
+    }
+
+    for (Connection& connection : connections) {
+        connection.thread.join();
+        ::close(connection.file_descriptor);
+    }
+
+    connections.clear();
+}
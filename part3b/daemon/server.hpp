@@ -0,0 +1,65 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <functional>
+#include <list>
+#include <thread>
+#include <atomic>
+#include <mutex>
+
+#include <sys/types.h>
+
+/*
+    Unix domain socket server with one thread per connection. Every request is a frame of
+    request_size doubles and every response a frame of response_size doubles, both in the byte
+    order of the machine. A connection may send any number of requests, one after the other.
+*/
+
+class Server {
+public:
+    // Return false to close the connection
+    using Handler = std::function<bool(const double* request, double* response)>;
+
+    Server(std::string socket_path, std::size_t request_size, std::size_t response_size, Handler handler)
+        : socket_path(std::move(socket_path)), request_size(request_size), response_size(response_size),
+        handler(std::move(handler)) {}
+
+    ~Server();
+
+    Server(const Server&) = delete;
+    Server& operator=(const Server&) = delete;
+
+    bool listen();
+
+    // Accept connections until stop() is called, from a signal handler too
+    void run();
+    void stop();
+private:
+    struct Connection {
+        int file_descriptor = -1;
+        std::thread thread;
+        std::atomic<bool> finished = false;
+    };
+
+    void serve(Connection& connection);
+    void join_finished_connections();
+    void close_connections();
+    void remove_socket();
+
+    std::string socket_path;
+    std::size_t request_size = 0;
+    std::size_t response_size = 0;
+    Handler handler;
+
+    int listening_file_descriptor = -1;
+
+    // Of the socket file bound by listen()
+    bool created_socket = false;
+    dev_t socket_device = 0;
+    ino_t socket_inode = 0;
+    std::atomic<bool> running = false;
+
+    std::list<Connection> connections;
+    std::mutex connections_mutex;
+};
@@ -9,10 +9,15 @@
 
 #include "application.hpp"
 #include "ui.hpp"
+#include "model_file.hpp"
+
+static constexpr const char* MODEL_FILE_NAME = "network.nn3b";
 
 void NnApplication::start() {
     std::srand(std::time(nullptr));
 
+    network.parallelism.pool = &thread_pool;
+
     ImPlot::CreateContext();
 }
 
@@ -28,7 +33,7 @@ void NnApplication::update() {
             }
 
             ui::file_browser([this](const std::string& file_path) {
-                learn.training_set.load(file_path, 30.0f);
+                learn.training_set.load(file_path, 30.0f, &thread_pool);
             });
 
             break;
@@ -38,6 +43,7 @@ void NnApplication::update() {
             const auto result = ui::learning_process(learn);
 
             if (result == ui::Operation::Start) {
+                normalization = learn.get_normalization();
                 learn.reset();
                 learn.start(network);
                 state = State::Learning;
@@ -47,6 +53,15 @@ void NnApplication::update() {
                 state = State::Testing;
             } else if (result == ui::Operation::Execute) {
                 state = State::Executing;
+            } else if (result == ui::Operation::Save) {
+                network::save(network, MODEL_FILE_NAME, normalization);
+            } else if (result == ui::Operation::Load) {
+                network::load(network, MODEL_FILE_NAME, &normalization);
+            } else if (result == ui::Operation::Resume) {
+                if (learn.resume(network, learn.checkpoints.options.file_name, &normalization)) {
+                    learn.start(network);
+                    state = State::Learning;
+                }
             }
 
             ui::learning_graph(learn);
@@ -76,7 +91,8 @@ void NnApplication::update() {
 
             break;
         case State::Executing:
-            if (ui::executing(network)) {
+            if (ui::executing(network, normalization, sweep)) {
+                sweep.cancel();
                 state = State::ReadyLearning;
             }
 
@@ -108,5 +124,6 @@ void NnApplication::update() {
 
 void NnApplication::dispose() {
     learn.stop();
+    sweep.cancel();
     ImPlot::DestroyContext();
 }
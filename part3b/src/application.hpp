@@ -6,6 +6,10 @@
 
 #include "network.hpp"
 #include "learn.hpp"
+#include "precision.hpp"
+#include "thread_pool.hpp"
+#include "statistics.hpp"
+#include "sweep.hpp"
 
 struct NnApplication : public gui_base::GuiApplication {
     NnApplication()
@@ -15,9 +19,17 @@ struct NnApplication : public gui_base::GuiApplication {
     virtual void update() override;
     virtual void dispose() override;
 
-    network::Network<18, 1> network;
+    ThreadPool thread_pool;
 
-    Learn<18, 1> learn;
+    network::Network<Precision, 18, 1> network;
+
+    // Of the inputs the network was trained on, or of the loaded model
+    Normalization normalization;
+
+    Learn<Precision, 18, 1> learn;
+
+    // Reads the network from its thread, so it's stopped before the network may change
+    Sweep<Precision, 18, 1> sweep;
 
     enum class State {
         Setup,
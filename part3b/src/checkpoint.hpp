@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <memory>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <chrono>
+
+#include "network.hpp"
+#include "model_file.hpp"
+
+/*
+    Periodic checkpoints of a network being trained. At the end of an epoch, if one is due, the
+    training thread only copies the weights into a spare snapshot; the file is saved, synced and
+    renamed over the previous checkpoint on a separate thread. There are at most three snapshots
+    (being written, pending and spare), so the training thread never waits on the disk: if the
+    disk falls behind, the pending snapshot is replaced by the newer one.
+
+    The first snapshots allocate, every other one reuses the memory of the weights.
+*/
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+class Checkpoints {
+public:
+    struct {
+        std::string file_name {"checkpoint.nn3b"};
+        unsigned long every_epochs {0};  // Zero for never
+        double every_seconds {0.0};  // Zero for never
+    } options;
+
+    Checkpoints() = default;
+
+    ~Checkpoints() {
+        stop();
+    }
+
+    Checkpoints(const Checkpoints&) = delete;
+    Checkpoints& operator=(const Checkpoints&) = delete;
+
+    // Count the epochs and the time from now
+    void begin(unsigned long epoch_index);
+
+    // Called by the training thread after every epoch; takes a snapshot if a checkpoint is due
+    void end_epoch(
+        const network::Network<Real, Inputs, Outputs>& network,
+        const Normalization& normalization,
+        const network::Progress& progress
+    );
+
+    // Write the pending snapshot, if any, then stop the thread
+    void stop();
+
+    std::size_t get_written() const {
+        return written.load(std::memory_order_relaxed);
+    }
+
+    std::size_t get_failed() const {
+        return failed.load(std::memory_order_relaxed);
+    }
+private:
+    struct Snapshot {
+        network::Network<Real, Inputs, Outputs> network;
+        Normalization normalization;
+        network::Progress progress;
+        std::string file_name;
+    };
+
+    void work();
+    bool write(const Snapshot& snapshot) const;
+
+    unsigned long last_epoch_index {0};
+    std::chrono::steady_clock::time_point last_time {std::chrono::steady_clock::now()};
+
+    std::unique_ptr<Snapshot> pending;
+    std::unique_ptr<Snapshot> spare;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool stopping {false};
+
+    std::atomic<std::size_t> written {0};
+    std::atomic<std::size_t> failed {0};
+};
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Checkpoints<Real, Inputs, Outputs>::begin(unsigned long epoch_index) {
+    last_epoch_index = epoch_index;
+    last_time = std::chrono::steady_clock::now();
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Checkpoints<Real, Inputs, Outputs>::end_epoch(
+    const network::Network<Real, Inputs, Outputs>& network,
+    const Normalization& normalization,
+    const network::Progress& progress
+) {
+    const auto now = std::chrono::steady_clock::now();
+
+    const bool epochs_due {options.every_epochs > 0 && progress.epoch_index - last_epoch_index >= options.every_epochs};
+    const bool time_due {options.every_seconds > 0.0 && std::chrono::duration<double>(now - last_time).count() >= options.every_seconds};
+
+    if (!epochs_due && !time_due) {
+        return;
+    }
+
+    last_epoch_index = progress.epoch_index;
+    last_time = now;
+
+    std::unique_ptr<Snapshot> snapshot;
+
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+
+        // Without a spare one, the pending snapshot is not written yet and is replaced
+        snapshot = spare ? std::move(spare) : std::move(pending);
+
+        if (!thread.joinable()) {
+            stopping = false;
+            thread = std::thread([this]() { work(); });
+        }
+    }
+
+    if (!snapshot) {
+        snapshot = std::make_unique<Snapshot>();
+    }
+
+    // Same sizes as last time, so the weights are copied into the memory already there
+    snapshot->network.hidden_layers = network.hidden_layers;
+    snapshot->network.output_layer = network.output_layer;
+    snapshot->normalization = normalization;
+    snapshot->progress = progress;
+    snapshot->file_name = options.file_name;
+
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        pending = std::move(snapshot);
+    }
+
+    condition.notify_one();
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Checkpoints<Real, Inputs, Outputs>::stop() {
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        stopping = true;
+    }
+
+    condition.notify_one();
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Checkpoints<Real, Inputs, Outputs>::work() {
+    while (true) {
+        std::unique_ptr<Snapshot> snapshot;
+
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+            condition.wait(lock, [this]() { return pending != nullptr || stopping; });
+
+            if (pending == nullptr) {
+                return;
+            }
+
+            snapshot = std::move(pending);
+        }
+
+        if (write(*snapshot)) {
+            written.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            failed.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        std::lock_guard<std::mutex> lock {mutex};
+
+        if (!spare) {
+            spare = std::move(snapshot);
+        }
+    }
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+bool Checkpoints<Real, Inputs, Outputs>::write(const Snapshot& snapshot) const {
+    // Saving never overwrites the last good checkpoint in place, so a crash can't leave it half written
+    return network::save(snapshot.network, snapshot.file_name, snapshot.normalization, &snapshot.progress);
+}
@@ -0,0 +1,308 @@
+#include <array>
+#include <cstddef>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+#include <algorithm>
+#include <optional>
+
+#include "csv.hpp"
+#include "mapped_file.hpp"
+#include "thread_pool.hpp"
+
+namespace csv {
+    static constexpr std::string_view BYTE_ORDER_MARK {"\xEF\xBB\xBF"};
+    static constexpr std::string_view HEADER {
+        "company_name,status_label,year,X1,X2,X3,X4,X5,X6,X7,X8,X9,X10,X11,X12,X13,X14,X15,X16,X17,X18"
+    };
+    static constexpr std::size_t FIELDS {21};
+    static constexpr std::size_t FIRST_FEATURE_FIELD {3};
+
+    // Chunks smaller than this are not worth a thread
+    static constexpr std::size_t MINIMUM_CHUNK_SIZE {64 * 1024};
+
+    // Rows of one chunk, or the first error in it
+    template<typename Real>
+    struct Chunk {
+        std::string_view text;
+        std::vector<Real> features;  // Packed, FEATURES for every label
+        std::vector<Real> labels;
+        std::size_t lines {0};
+        std::optional<Error> error;
+    };
+
+    std::string Error::to_string() const {
+        if (line == 0) {
+            return message;
+        }
+
+        std::string text {"Line "};
+        text.append(std::to_string(line)).append(", column ").append(std::to_string(column)).append(": ").append(message);
+
+        return text;
+    }
+
+    static std::string_view strip_line(std::string_view line) {
+        if (!line.empty() && line.back() == '\r') {
+            line.remove_suffix(1);
+        }
+
+        return line;
+    }
+
+    template<typename Real>
+    static bool parse_number(std::string_view token, Real& value) {
+        // std::stod accepted a plus sign, so keep accepting it
+        if (!token.empty() && token.front() == '+') {
+            token.remove_prefix(1);
+        }
+
+        double result {0.0};
+        const auto [end, code] = std::from_chars(token.data(), token.data() + token.size(), result);
+
+        if (code != std::errc() || end != token.data() + token.size() || token.empty()) {
+            return false;
+        }
+
+        value = static_cast<Real>(result);
+
+        return true;
+    }
+
+    // Line is the number of the line in the chunk, starting from zero
+    template<typename Real>
+    static std::optional<Error> parse_line(std::string_view line, std::size_t line_index, Real* features, Real& label) {
+        const auto error = [line_index](std::size_t column, std::string message) {
+            return std::make_optional(Error {line_index, column + 1, std::move(message)});
+        };
+
+        std::size_t field {0};
+        std::size_t begin {0};
+
+        while (true) {
+            const std::size_t end {std::min(line.find(',', begin), line.size())};
+            const std::string_view token {line.substr(begin, end - begin)};
+
+            if (field >= FIELDS) {
+                std::string message {"Expected "};
+                message.append(std::to_string(FIELDS)).append(" fields, found more");
+
+                return error(begin, std::move(message));
+            }
+
+            if (field == 1) {
+                if (token == "alive") {
+                    label = static_cast<Real>(1.0);
+                } else if (token == "failed") {
+                    label = static_cast<Real>(0.0);
+                } else {
+                    std::string message {"Expected alive or failed, found '"};
+                    message.append(token).append("'");
+
+                    return error(begin, std::move(message));
+                }
+            } else if (field >= FIRST_FEATURE_FIELD) {
+                if (!parse_number(token, features[field - FIRST_FEATURE_FIELD])) {
+                    std::string message {"X"};
+                    message.append(std::to_string(field - FIRST_FEATURE_FIELD + 1)).append(" is not a number: '").append(token).append("'");
+
+                    return error(begin, std::move(message));
+                }
+            }
+
+            field++;
+
+            if (end == line.size()) {
+                break;
+            }
+
+            begin = end + 1;
+        }
+
+        if (field < FIELDS) {
+            std::string message {"Expected "};
+            message.append(std::to_string(FIELDS)).append(" fields, found ").append(std::to_string(field));
+
+            return error(line.size(), std::move(message));
+        }
+
+        return std::nullopt;
+    }
+
+    template<typename Real>
+    static void parse_chunk(Chunk<Real>& chunk) {
+        std::string_view text {chunk.text};
+
+        // About the size of a line of the dataset, to allocate only a few times
+        chunk.features.reserve(text.size() / 128 * FEATURES);
+        chunk.labels.reserve(text.size() / 128);
+
+        while (!text.empty()) {
+            const std::size_t end {std::min(text.find('\n'), text.size())};
+            const std::string_view line {strip_line(text.substr(0, end))};
+
+            // Empty lines, like the one at the end of the file, are skipped
+            if (!line.empty()) {
+                const std::size_t row {chunk.labels.size()};
+
+                chunk.features.resize((row + 1) * FEATURES);
+                chunk.labels.push_back(static_cast<Real>(0.0));
+
+                if (std::optional<Error> error {parse_line(line, chunk.lines, chunk.features.data() + row * FEATURES, chunk.labels.back())}) {
+                    chunk.error = std::move(error);
+                    return;
+                }
+            }
+
+            chunk.lines++;
+            text.remove_prefix(std::min(end + 1, text.size()));
+        }
+    }
+
+    // Split in about equal chunks, each ending after a newline or at the end
+    template<typename Real>
+    static std::vector<Chunk<Real>> split(std::string_view text, std::size_t count) {
+        std::vector<Chunk<Real>> chunks;
+        chunks.reserve(count);
+
+        std::size_t begin {0};
+
+        for (std::size_t i {1}; i <= count && begin < text.size(); i++) {
+            std::size_t end {text.size() * i / count};
+
+            if (i < count && end > begin) {
+                end = text.find('\n', end - 1);
+                end = end == std::string_view::npos ? text.size() : end + 1;
+            }
+
+            end = std::max(end, begin);
+
+            if (end > begin) {
+                Chunk<Real> chunk;
+                chunk.text = text.substr(begin, end - begin);
+
+                chunks.push_back(std::move(chunk));
+            }
+
+            begin = end;
+        }
+
+        return chunks;
+    }
+
+    std::size_t header_size(std::string_view text) {
+        std::size_t size {0};
+
+        if (text.substr(0, BYTE_ORDER_MARK.size()) == BYTE_ORDER_MARK) {
+            size += BYTE_ORDER_MARK.size();
+        }
+
+        const std::size_t end {std::min(text.find('\n', size), text.size())};
+
+        if (strip_line(text.substr(size, end - size)) != HEADER) {
+            return 0;
+        }
+
+        return std::min(end + 1, text.size());
+    }
+
+    template<typename Real>
+    bool parse_rows(std::string_view text, std::vector<Real>& features, std::vector<Real>& labels, Error& error) {
+        Chunk<Real> chunk;
+        chunk.text = text;
+        chunk.features = std::move(features);
+        chunk.features.clear();
+        chunk.labels = std::move(labels);
+        chunk.labels.clear();
+
+        parse_chunk(chunk);
+
+        features = std::move(chunk.features);
+        labels = std::move(chunk.labels);
+
+        if (chunk.error) {
+            error = *chunk.error;
+            error.line += 1;
+
+            return false;
+        }
+
+        return true;
+    }
+
+    template<typename Real>
+    bool parse(std::string_view file_name, Matrix<Real>& features, std::vector<Real>& labels, Error& error, ThreadPool* pool) {
+        MappedFile file;
+
+        if (!file.open(std::string(file_name))) {
+            error = {0, 0, std::string("Could not open ").append(file_name)};
+            return false;
+        }
+
+        std::string_view text {reinterpret_cast<const char*>(file.get_data()), file.get_size()};
+
+        const std::size_t header {header_size(text)};
+
+        if (header == 0) {
+            error = {1, 1, std::string("Expected the header ").append(HEADER)};
+            return false;
+        }
+
+        text.remove_prefix(header);
+
+        const std::size_t threads {pool != nullptr ? pool->size() : 1};
+        const std::size_t count {std::clamp<std::size_t>(text.size() / MINIMUM_CHUNK_SIZE, 1, threads)};
+
+        std::vector<Chunk<Real>> chunks {split<Real>(text, count)};
+
+        if (pool != nullptr) {
+            pool->parallel_for(chunks.size(), [&chunks](std::size_t begin, std::size_t end) {
+                for (std::size_t i {begin}; i < end; i++) {
+                    parse_chunk(chunks[i]);
+                }
+            });
+        } else {
+            for (Chunk<Real>& chunk : chunks) {
+                parse_chunk(chunk);
+            }
+        }
+
+        // Lines of the chunks are counted from the header, which is line 1
+        std::size_t first_line {2};
+        std::size_t rows {0};
+
+        for (Chunk<Real>& chunk : chunks) {
+            if (chunk.error) {
+                error = *chunk.error;
+                error.line += first_line;
+
+                return false;
+            }
+
+            first_line += chunk.lines;
+            rows += chunk.labels.size();
+        }
+
+        // Only now are the rows known, so they are copied into their aligned places once
+        features = Matrix<Real>(rows, FEATURES);
+        labels.clear();
+        labels.reserve(rows);
+
+        for (const Chunk<Real>& chunk : chunks) {
+            for (std::size_t i {0}; i < chunk.labels.size(); i++) {
+                std::copy_n(chunk.features.data() + i * FEATURES, FEATURES, features.row(labels.size()));
+                labels.push_back(chunk.labels[i]);
+            }
+        }
+
+        return true;
+    }
+
+    template bool parse(std::string_view file_name, Matrix<float>& features, std::vector<float>& labels, Error& error, ThreadPool* pool);
+    template bool parse(std::string_view file_name, Matrix<double>& features, std::vector<double>& labels, Error& error, ThreadPool* pool);
+
+    template bool parse_rows(std::string_view text, std::vector<float>& features, std::vector<float>& labels, Error& error);
+    template bool parse_rows(std::string_view text, std::vector<double>& features, std::vector<double>& labels, Error& error);
+}
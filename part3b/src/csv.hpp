@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "matrix.hpp"
+
+class ThreadPool;
+
+/*
+    Loader of the bankruptcy dataset. The file is mapped and split in one chunk for every thread,
+    each starting after a newline, and the chunks are parsed in parallel straight from the mapping,
+    with std::from_chars on the tokens. Errors are reported with their line and column.
+
+    company_name,status_label,year,X1,...,X18
+*/
+
+namespace csv {
+    // X1 to X18, the inputs of the networks
+    inline constexpr std::size_t FEATURES {18};
+
+    struct Error {
+        std::size_t line = 0;  // Starting from 1, zero for errors not on a line, like a missing file
+        std::size_t column = 0;  // Starting from 1
+        std::string message;
+
+        std::string to_string() const;
+    };
+
+    // Return false and fill the error, if the file can't be read or any line is invalid; the
+    // rows are in the order of the file, one row of FEATURES features for every label
+    template<typename Real>
+    bool parse(std::string_view file_name, Matrix<Real>& features, std::vector<Real>& labels, Error& error, ThreadPool* pool = nullptr);
+
+    // Size of the header line at the start of the text, with the byte order mark and the newline,
+    // or zero if the text doesn't start with the header
+    std::size_t header_size(std::string_view text);
+
+    // Rows of whole lines, without the header, packed FEATURES features after another; the lines
+    // of errors count from the start of the text
+    template<typename Real>
+    bool parse_rows(std::string_view text, std::vector<Real>& features, std::vector<Real>& labels, Error& error);
+}
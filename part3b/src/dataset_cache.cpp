@@ -0,0 +1,256 @@
+#include <array>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <cassert>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "dataset_cache.hpp"
+#include "mapped_file.hpp"
+#include "csv.hpp"
+
+namespace dataset_cache {
+    static constexpr std::array<char, 4> MAGIC { 'N', 'N', '3', 'D' };
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    struct Header {
+        std::array<char, 4> magic {};
+        std::uint32_t version = 0;
+        std::uint32_t real_size = 0;
+        std::uint32_t columns = 0;
+        std::uint64_t rows = 0;
+        std::uint64_t source_size = 0;
+        std::uint64_t source_time = 0;
+        std::uint64_t source_hash = 0;
+        std::uint64_t reserved[2] {};
+    };
+
+    static_assert(sizeof(Header) == 64);
+    static_assert(sizeof(Header) % ALIGNMENT == 0);
+
+    static constexpr std::uint64_t align(std::uint64_t offset) {
+        return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+    }
+
+    // Every column takes the same aligned space; the labels are the last column
+    static constexpr std::uint64_t column_size(std::uint64_t rows, std::size_t real_size) {
+        return align(rows * real_size);
+    }
+
+    static constexpr std::uint64_t column_offset(std::size_t column, std::uint64_t rows, std::size_t real_size) {
+        return sizeof(Header) + column * column_size(rows, real_size);
+    }
+
+    // FNV-1a
+    static std::uint64_t hash(const unsigned char* bytes, std::size_t size) {
+        std::uint64_t result = 14'695'981'039'346'656'037ull;
+
+        for (std::size_t i = 0; i < size; i++) {
+            result ^= bytes[i];
+            result *= 1'099'511'628'211ull;
+        }
+
+        return result;
+    }
+
+    // Unique for every save, so that processes caching the same source at once don't write into the
+    // same file; the last rename wins, with a whole cache
+    static std::string temporary_file_name(const std::string& cache_file_name) {
+        std::random_device device;
+        const std::uint64_t suffix {(static_cast<std::uint64_t>(device()) << 32) | device()};
+
+        std::array<char, 16> digits {};
+        const auto result {std::to_chars(digits.data(), digits.data() + digits.size(), suffix, 16)};
+
+        std::string name {cache_file_name};
+        name.append(".").append(digits.data(), result.ptr).append(".tmp");
+
+        return name;
+    }
+
+    std::string file_name(std::string_view source, std::size_t real_size) {
+        return std::string(source) + (real_size == sizeof(float) ? ".f32.cache" : ".f64.cache");
+    }
+
+    bool stat_source(std::string_view source, Key& key) {
+        std::error_code error;
+
+        const std::uintmax_t size = std::filesystem::file_size(source, error);
+
+        if (error) {
+            return false;
+        }
+
+        const std::filesystem::file_time_type time = std::filesystem::last_write_time(source, error);
+
+        if (error) {
+            return false;
+        }
+
+        key.size = static_cast<std::uint64_t>(size);
+        key.time = static_cast<std::uint64_t>(time.time_since_epoch().count());
+
+        return true;
+    }
+
+    bool hash_source(std::string_view source, Key& key) {
+        MappedFile file;
+
+        if (!file.open(std::string(source))) {
+            return false;
+        }
+
+        key.hash = hash(file.get_data(), file.get_size());
+
+        return true;
+    }
+
+    template<typename Real>
+    bool load(std::string_view source, const Key& key, Matrix<Real>& features, std::vector<Real>& labels) {
+        const std::string cache_file_name {file_name(source, sizeof(Real))};
+
+        MappedFile file;
+
+        if (!file.open(cache_file_name) || file.get_size() < sizeof(Header)) {
+            return false;
+        }
+
+        Header header;
+        std::memcpy(&header, file.get_data(), sizeof(header));
+
+        if (header.magic != MAGIC || header.version != VERSION || header.real_size != sizeof(Real)) {
+            return false;
+        }
+
+        // The normalization and the networks have exactly this many inputs
+        if (header.columns != csv::FEATURES) {
+            return false;
+        }
+
+        // Checked before computing the size, which could overflow otherwise
+        if (header.rows > file.get_size() / sizeof(Real)) {
+            return false;
+        }
+
+        const std::uint64_t size_of_column {column_size(header.rows, sizeof(Real))};
+
+        if (size_of_column > 0 && header.columns >= file.get_size() / size_of_column) {
+            return false;
+        }
+
+        const std::size_t columns {header.columns};
+
+        if (column_offset(columns + 1, header.rows, sizeof(Real)) != file.get_size() || header.source_size != key.size) {
+            return false;
+        }
+
+        if (header.source_time != key.time) {
+            Key hashed_key {key};
+
+            if (!hash_source(source, hashed_key) || hashed_key.hash != header.source_hash) {
+                return false;
+            }
+
+            // Only touched, so the cache is still good; next time the hash is not needed
+            std::fstream stream {cache_file_name, std::ios::binary | std::ios::in | std::ios::out};
+
+            if (stream.is_open()) {
+                stream.seekp(offsetof(Header, source_time));
+                stream.write(reinterpret_cast<const char*>(&key.time), sizeof(key.time));
+            }
+        }
+
+        const std::size_t rows {static_cast<std::size_t>(header.rows)};
+
+        features = Matrix<Real>(rows, columns);
+
+        for (std::size_t j {0}; j < columns; j++) {
+            const Real* column {reinterpret_cast<const Real*>(file.get_data() + column_offset(j, rows, sizeof(Real)))};
+
+            for (std::size_t i {0}; i < rows; i++) {
+                features(i, j) = column[i];
+            }
+        }
+
+        const Real* label_column {reinterpret_cast<const Real*>(file.get_data() + column_offset(columns, rows, sizeof(Real)))};
+
+        labels.assign(label_column, label_column + rows);
+
+        return true;
+    }
+
+    template<typename Real>
+    bool save(std::string_view source, const Key& key, const Matrix<Real>& features, const std::vector<Real>& labels) {
+        assert(features.get_rows() == labels.size());
+
+        const std::string cache_file_name {file_name(source, sizeof(Real))};
+        const std::string temporary {temporary_file_name(cache_file_name)};
+
+        Header header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.real_size = sizeof(Real);
+        header.columns = static_cast<std::uint32_t>(features.get_columns());
+        header.rows = labels.size();
+        header.source_size = key.size;
+        header.source_time = key.time;
+        header.source_hash = key.hash;
+
+        {
+            std::ofstream stream {temporary, std::ios::binary | std::ios::trunc};
+
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            // Zero padded to the aligned size of a column
+            std::vector<Real> column(column_size(labels.size(), sizeof(Real)) / sizeof(Real));
+
+            for (std::size_t j {0}; j <= features.get_columns(); j++) {
+                for (std::size_t i {0}; i < labels.size(); i++) {
+                    column[i] = j < features.get_columns() ? features(i, j) : labels[i];
+                }
+
+                stream.write(reinterpret_cast<const char*>(column.data()), static_cast<std::streamsize>(column.size() * sizeof(Real)));
+            }
+
+            stream.flush();
+            stream.close();
+
+            if (!stream.good()) {
+                std::error_code error;
+                std::filesystem::remove(temporary, error);
+
+                return false;
+            }
+        }
+
+        // Replaced in one step, so that a cache is never seen half written
+        std::error_code error;
+        std::filesystem::rename(temporary, cache_file_name, error);
+
+        if (error) {
+            std::filesystem::remove(temporary, error);
+
+            return false;
+        }
+
+        return true;
+    }
+
+    template bool load(std::string_view source, const Key& key, Matrix<float>& features, std::vector<float>& labels);
+    template bool load(std::string_view source, const Key& key, Matrix<double>& features, std::vector<double>& labels);
+
+    template bool save(std::string_view source, const Key& key, const Matrix<float>& features, const std::vector<float>& labels);
+    template bool save(std::string_view source, const Key& key, const Matrix<double>& features, const std::vector<double>& labels);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "matrix.hpp"
+
+/*
+    Columnar binary copy of a CSV training set, written the first time the CSV is parsed. Later
+    loads map it instead of parsing the CSV, but the columns are still copied, element by element,
+    into the rows of the Matrix of the set; the set is reordered and normalized in place, so it
+    can't view the mapped file. There is one cache for every precision, next to the CSV:
+
+    header (64 bytes)
+        "NN3D", version, size of Real, column count (all uint32), row count, size of the source,
+        modification time of the source, hash of the source (all uint64), reserved
+    every column of features, then the labels, aligned to 64 bytes
+        row count Reals
+
+    The cache is used as long as the size and the modification time of the source are the same.
+    If only the time changed, the source is hashed and, if its content is the same, the cache is
+    still used and its time is updated. Otherwise it's rebuilt.
+*/
+
+namespace dataset_cache {
+    // Size, modification time and hash of the source; the hash is only computed when needed
+    struct Key {
+        std::uint64_t size = 0;
+        std::uint64_t time = 0;
+        std::uint64_t hash = 0;
+    };
+
+    std::string file_name(std::string_view source, std::size_t real_size);
+
+    // Return false, if the source can't be read
+    bool stat_source(std::string_view source, Key& key);
+    bool hash_source(std::string_view source, Key& key);
+
+    // Copy the cached set into features and labels; return false and leave them unchanged, if the
+    // cache is missing, invalid or stale, or hasn't csv::FEATURES columns
+    template<typename Real>
+    bool load(std::string_view source, const Key& key, Matrix<Real>& features, std::vector<Real>& labels);
+
+    // The key must be hashed; return false on any I/O error
+    template<typename Real>
+    bool save(std::string_view source, const Key& key, const Matrix<Real>& features, const std::vector<Real>& labels);
+}
@@ -1,314 +1,207 @@
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
-#include <fstream>
 #include <string>
-#include <cstring>
 #include <cassert>
 #include <utility>
-#include <iterator>
 #include <regex>
-#include <stdexcept>
-#include <optional>
 #include <memory>
+#include <numeric>
+#include <algorithm>
+#include <span>
+#include <array>
+#include <tuple>
 
 #include "helpers.hpp"
+#include "dataset_cache.hpp"
+#include "csv.hpp"
+#include "sampler.hpp"
 
-static std::optional<double> parse_classification(const char* string) {
-    if (std::strcmp(string, "alive") == 0) {
-        return std::make_optional(1.0);
-    } else if (std::strcmp(string, "failed") == 0) {
-        return std::make_optional(0.0);
-    }
-
-    return std::nullopt;
-}
-
-static std::optional<double> parse_number(const char* string) {
-    double result;
-
-    try {
-        result = std::stod(string);
-    } catch (const std::invalid_argument& e) {
-        return std::nullopt;
-    } catch (const std::out_of_range& e) {
-        return std::nullopt;
-    }
-
-    return std::make_optional(result);
-}
-
-static constexpr double map(double x, double in_min, double in_max, double out_min, double out_max) {
-    return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min;
-}
-
-static bool check_line(const std::string& line) {
-    return line.find("company_name,status_label,year,X1,X2,X3,X4,X5,X6,X7,X8,X9,X10,X11,X12,X13,X14,X15,X16,X17,X18");
-}
-
-bool TrainingSet::load(std::string_view file_name, float percent_for_testing) {
-    std::ifstream stream {std::string(file_name)};
-
-    if (!stream.is_open()) {
-        return false;
-    }
+template<typename Real>
+bool TrainingSet<Real>::load(std::string_view file_name, float percent_for_testing, ThreadPool* pool) {
+    loaded = false;
+    error.clear();
 
-    data.clear();
+    dataset_cache::Key key;
 
-    std::string line;
-
-    // Consume first line
-    if (!std::getline(stream, line)) {
+    if (!dataset_cache::stat_source(file_name, key)) {
+        error = "Could not open " + std::string(file_name);
         return false;
     }
 
-    if (!check_line(line)) {
-        loaded = false;
+    if (!dataset_cache::load(file_name, key, features, labels)) {
+        csv::Error csv_error;
 
-        return false;
-    }
-
-    while (true) {
-        if (!std::getline(stream, line)) {
-            break;
+        if (!csv::parse(file_name, features, labels, csv_error, pool)) {
+            error = csv_error.to_string();
+            return false;
         }
 
-        Instance instance;
-
-        if (line[line.size() - 1] == '\r') {
-            line.pop_back();
+        // Without a cache, like in a read-only directory, the next load only parses again
+        if (dataset_cache::hash_source(file_name, key)) {
+            dataset_cache::save(file_name, key, features, labels);
         }
+    }
 
-        char* token {nullptr};
-        std::optional<double> value;
-
-        token = std::strtok(line.data(), ",");
-        // Skip name
+    loaded = true;
+    normalized = false;
 
-        token = std::strtok(nullptr, ",");
-        value = parse_classification(token);
-        if (value) {
-            instance.classification = *value;
-        } else {
-            return false;
-        }
+    set_testing(percent_for_testing, pool);
 
-        token = std::strtok(nullptr, ",");
-        // Skip year
+    return true;
+}
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.current_assets = *value;
-        } else {
-            return false;
-        }
+template<typename Real>
+void TrainingSet<Real>::shuffle(std::uint64_t seed, ThreadPool* pool) {
+    Sampler sampler {seed};
+    sampler.reset(size());
+    sampler.shuffle();
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.cost_of_goods_sold = *value;
-        } else {
-            return false;
-        }
+    // Split from the new order, so the rows are moved only once
+    split(sampler.get_order(), pool);
+}
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.depreciation_and_amortization = *value;
-        } else {
-            return false;
-        }
+template<typename Real>
+void TrainingSet<Real>::normalize() {
+    if (normalized) {
+        return;
+    }
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.financial_performance = *value;
-        } else {
-            return false;
-        }
+    normalize_rows(features.get_data(), size(), features.get_columns(), features.get_stride(), normalization);
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.inventory = *value;
-        } else {
-            return false;
-        }
+    normalized = true;
+}
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.net_income = *value;
-        } else {
-            return false;
-        }
+template<typename Real>
+void TrainingSet<Real>::set_testing(float percent_for_testing, ThreadPool* pool) {
+    this->percent_for_testing = percent_for_testing;
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_receivables = *value;
-        } else {
-            return false;
-        }
+    std::vector<std::size_t> order(size());
+    std::iota(order.begin(), order.end(), 0);
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.market_value = *value;
-        } else {
-            return false;
-        }
+    split(order, pool);
+}
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.net_sales = *value;
-        } else {
-            return false;
-        }
+template<typename Real>
+void TrainingSet<Real>::split(const std::vector<std::size_t>& order, ThreadPool* pool) {
+    assert(percent_for_testing > 0.0f && percent_for_testing < 100.0f);
+    assert(order.size() == size());
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_assets = *value;
-        } else {
-            return false;
-        }
+    // There are only a few labels, so they are searched linearly
+    std::vector<Real> classes;
+    std::vector<std::size_t> class_sizes;
+    std::vector<std::size_t> row_classes(order.size());
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_long_term_debt = *value;
-        } else {
-            return false;
-        }
+    for (std::size_t i {0}; i < order.size(); i++) {
+        const Real label {labels[order[i]]};
+        const std::size_t c {static_cast<std::size_t>(std::find(classes.begin(), classes.end(), label) - classes.begin())};
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.earnings_before_interest_and_taxes = *value;
-        } else {
-            return false;
+        if (c == classes.size()) {
+            classes.push_back(label);
+            class_sizes.push_back(0);
         }
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.gross_profit = *value;
-        } else {
-            return false;
-        }
+        class_sizes[c]++;
+        row_classes[i] = c;
+    }
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_current_liabilities = *value;
-        } else {
-            return false;
-        }
+    // The same part of every label is for testing
+    std::vector<std::size_t> training_left(classes.size());
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.retained_earnings = *value;
-        } else {
-            return false;
-        }
+    for (std::size_t c {0}; c < classes.size(); c++) {
+        const double instances_for_testing {(static_cast<double>(class_sizes[c]) * percent_for_testing) / 100.0f};
+        training_left[c] = class_sizes[c] - static_cast<std::size_t>(instances_for_testing);
+    }
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_revenue = *value;
-        } else {
-            return false;
-        }
+    // Both partitions keep the relative order of the rows
+    std::vector<std::size_t> new_order;
+    std::vector<std::size_t> testing_order;
+    new_order.reserve(order.size());
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_liabilities = *value;
-        } else {
-            return false;
-        }
+    for (std::size_t i {0}; i < order.size(); i++) {
+        std::size_t& left {training_left[row_classes[i]]};
 
-        token = std::strtok(nullptr, ",");
-        value = parse_number(token);
-        if (value) {
-            instance.total_operating_expenses = *value;
+        if (left > 0) {
+            new_order.push_back(order[i]);
+            left--;
         } else {
-            return false;
+            testing_order.push_back(order[i]);
         }
-
-        data.push_back(instance);
     }
 
-    loaded = true;
+    training_instance_count = new_order.size();
+    new_order.insert(new_order.end(), testing_order.begin(), testing_order.end());
 
-    set_testing(percent_for_testing);
+    reorder(new_order);
 
-    return true;
+    // Normalized features can't give the statistics of the data anymore
+    if (!normalized) {
+        statistics = compute_statistics(features, training_instance_count, pool);
+        normalization = make_normalization(statistics);
+    }
 }
 
-void TrainingSet::shuffle() {
-    std::vector<Instance> new_data;
-    new_data.reserve(data.size());
+template<typename Real>
+void TrainingSet<Real>::reorder(const std::vector<std::size_t>& order) {
+    Matrix<Real> new_features {size(), features.get_columns()};
+    std::vector<Real> new_labels(size());
 
-    while (!data.empty()) {
-        const std::size_t index {static_cast<std::size_t>(std::rand() % data.size())};
-        new_data.push_back(data[index]);
-        data.erase(std::next(data.cbegin(), index));
+    for (std::size_t i {0}; i < order.size(); i++) {
+        std::copy_n(features.row(order[i]), features.get_columns(), new_features.row(i));
+        new_labels[i] = labels[order[i]];
     }
 
-    data = std::move(new_data);
+    features = std::move(new_features);
+    labels = std::move(new_labels);
 }
 
-void TrainingSet::normalize() {
-    if (normalized) {
-        return;
-    }
+template<typename Real>
+void normalize_features(std::span<Real> features, const Normalization& normalization) {
+    normalize_rows(features.data(), 1, features.size(), features.size(), normalization);
+}
 
-    for (Instance& instance : data) {
-        normalize_instance(instance);
-    }
+template<typename Real>
+void normalize_rows(Real* rows, std::size_t count, std::size_t columns, std::size_t stride, const Normalization& normalization) {
+    assert(columns <= normalization.minimum.size());
 
-    normalized = true;
-}
+    // (x - offset) * scale for every column, without a division for every element
+    std::array<Real, std::tuple_size_v<decltype(Normalization::minimum)>> offsets {};
+    std::array<Real, std::tuple_size_v<decltype(Normalization::minimum)>> scales {};
 
-void TrainingSet::set_testing(float percent_for_testing) {
-    assert(percent_for_testing > 0.0f && percent_for_testing < 100.0f);
+    for (std::size_t j {0}; j < columns; j++) {
+        offsets[j] = static_cast<Real>(normalization.minimum[j]);
+        scales[j] = static_cast<Real>(1.0 / (normalization.maximum[j] - normalization.minimum[j]));
+    }
 
-    const double instances_for_testing {(static_cast<double>(data.size()) * percent_for_testing) / 100.0f};
-    training_instance_count = data.size() - static_cast<std::size_t>(instances_for_testing);
-}
+    for (std::size_t i {0}; i < count; i++) {
+        Real* row {rows + i * stride};
 
-void normalize_instance(Instance& instance) {
-    instance.current_assets =                     map(instance.current_assets, -7.76, 170'000.0, 0.0, 1.0);
-    instance.cost_of_goods_sold =                 map(instance.cost_of_goods_sold, -367.0, 375'000.0, 0.0, 1.0);
-    instance.depreciation_and_amortization =      map(instance.depreciation_and_amortization, 0.0, 28'400.0, 0.0, 1.0);
-    instance.financial_performance =              map(instance.financial_performance, -21'900.0, 81'700.0, 0.0, 1.0);
-    instance.inventory =                          map(instance.inventory, 0.0, 62'600.0, 0.0, 1.0);
-    instance.net_income =                         map(instance.net_income, -98'700.0, 105'000.0, 0.0, 1.0);
-    instance.total_receivables =                  map(instance.total_receivables, -0.01, 65'800.0, 0.0, 1.0);
-    instance.market_value =                       map(instance.market_value, 0.0, 1'070'000.0, 0.0, 1.0);
-    instance.net_sales =                          map(instance.net_sales, -1'960.0, 512'000.0, 0.0, 1.0);
-    instance.total_assets =                       map(instance.total_assets, 0.0, 532'000.0, 0.0, 1.0);
-    instance.total_long_term_debt =               map(instance.total_long_term_debt, -0.02, 166'000.0, 0.0, 1.0);
-    instance.earnings_before_interest_and_taxes = map(instance.earnings_before_interest_and_taxes, -25'900.0, 71'200.0, 0.0, 1.0);
-    instance.gross_profit =                       map(instance.gross_profit, -21'500.0, 137'000.0, 0.0, 1.0);
-    instance.total_current_liabilities =          map(instance.total_current_liabilities, 0.0, 117'000.0, 0.0, 1.0);
-    instance.retained_earnings =                  map(instance.retained_earnings, -102'000.0, 402'000.0, 0.0, 1.0);
-    instance.total_revenue =                      map(instance.total_revenue, -1'960.0, 512'000.0, 0.0, 1.0);
-    instance.total_liabilities =                  map(instance.total_liabilities, 0.0, 338'000.0, 0.0, 1.0);
-    instance.total_operating_expenses =           map(instance.total_operating_expenses, -317.0, 482'000.0, 0.0, 1.0);
+        for (std::size_t j {0}; j < columns; j++) {
+            row[j] = (row[j] - offsets[j]) * scales[j];
+        }
+    }
 }
 
-void reallocate_double_array_random(double** array, std::size_t* old_size, std::size_t size) {
-    delete[] *array;
-    *array = new double[size];
-    *old_size = size;
+template<typename Real>
+void randomize_matrix(Matrix<Real>& matrix) {
+    for (std::size_t i {0}; i < matrix.get_rows(); i++) {
+        Real* row {matrix.row(i)};
 
-    for (std::size_t i {0}; i < size; i++) {
-        const double normalized {static_cast<double>(std::rand()) / static_cast<double>(RAND_MAX)};
-        (*array)[i] = normalized * 2.0f - 1.0f;
+        for (std::size_t j {0}; j < matrix.get_columns(); j++) {
+            const double normalized {static_cast<double>(std::rand()) / static_cast<double>(RAND_MAX)};
+            row[j] = static_cast<Real>(normalized * 2.0f - 1.0f);
+        }
     }
 }
+
+template struct TrainingSet<float>;
+template struct TrainingSet<double>;
+
+template void normalize_features(std::span<float> features, const Normalization& normalization);
+template void normalize_features(std::span<double> features, const Normalization& normalization);
+
+template void normalize_rows(float* rows, std::size_t count, std::size_t columns, std::size_t stride, const Normalization& normalization);
+template void normalize_rows(double* rows, std::size_t count, std::size_t columns, std::size_t stride, const Normalization& normalization);
+
+template void randomize_matrix(Matrix<float>& matrix);
+template void randomize_matrix(Matrix<double>& matrix);
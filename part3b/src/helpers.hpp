@@ -1,43 +1,78 @@
 #pragma once
 
 #include <cstddef>
+#include <cstdint>
+#include <string>
 #include <string_view>
 #include <vector>
+#include <array>
+#include <span>
 
-struct Instance {
-    double current_assets;
-    double cost_of_goods_sold;
-    double depreciation_and_amortization;
-    double financial_performance;
-    double inventory;
-    double net_income;
-    double total_receivables;
-    double market_value;
-    double net_sales;
-    double total_assets;
-    double total_long_term_debt;
-    double earnings_before_interest_and_taxes;
-    double gross_profit;
-    double total_current_liabilities;
-    double retained_earnings;
-    double total_revenue;
-    double total_liabilities;
-    double total_operating_expenses;
-
-    double classification;
+#include "matrix.hpp"
+#include "statistics.hpp"
+
+class ThreadPool;
+
+// One instance of a training set, viewing the memory of the set
+template<typename Real>
+struct Sample {
+    std::span<const Real> features;
+    Real label {0.0};
 };
 
+// The features of every instance are the rows of a matrix, aligned like the weights, so a row is
+// given to the network as it is and the testing partition is run as one batch in place. The
+// training partition comes first, the testing partition last.
+template<typename Real>
 struct TrainingSet {
-    std::vector<Instance> data;
+    Matrix<Real> features;
+    std::vector<Real> labels;  // 1.0 for alive, 0.0 for failed
     bool loaded = false;
     bool normalized = false;
     std::size_t training_instance_count {0};
+    float percent_for_testing {30.0f};
+    std::string error;  // Why the last load failed
+
+    // Of the training partition only, so nothing of the testing partition leaks into the inputs,
+    // and the normalization made from them. They follow every new split until the set is normalized
+    Statistics statistics;
+    Normalization normalization;
 
-    bool load(std::string_view file_name, float percent_for_testing);
-    void shuffle();
+    // The CSV is parsed and the statistics are computed on the threads of the pool, if not null
+    bool load(std::string_view file_name, float percent_for_testing, ThreadPool* pool = nullptr);
+
+    // Put the instances in a random order and split them again; after normalize(), the
+    // normalization of the previous training partition stays
+    void shuffle(std::uint64_t seed, ThreadPool* pool = nullptr);
     void normalize();
-    void set_testing(float percent_for_testing);
+
+    // Stratified split: the last instances of every label go to testing, so both partitions have
+    // the same ratio of alive to failed instances as the whole set
+    void set_testing(float percent_for_testing, ThreadPool* pool = nullptr);
+
+    std::size_t size() const {
+        return labels.size();
+    }
+
+    std::span<const Real> row(std::size_t index) const {
+        return {features.row(index), features.get_columns()};
+    }
+
+    Sample<Real> sample(std::size_t index) const {
+        return {row(index), labels[index]};
+    }
+private:
+    void split(const std::vector<std::size_t>& order, ThreadPool* pool);
+    void reorder(const std::vector<std::size_t>& order);
 };
 
-void normalize_instance(Instance& instance);
-void reallocate_double_array_random(double** array, std::size_t* old_size, std::size_t size);
+// Map the features of one instance in place, in the order of the inputs of the networks
+template<typename Real>
+void normalize_features(std::span<Real> features, const Normalization& normalization);
+
+// Map count rows of columns features in place, with consecutive rows stride elements apart
+template<typename Real>
+void normalize_rows(Real* rows, std::size_t count, std::size_t columns, std::size_t stride, const Normalization& normalization);
+
+template<typename Real>
+void randomize_matrix(Matrix<Real>& matrix);
@@ -2,13 +2,23 @@
 
 #include <array>
 #include <cstddef>
+#include <cstdint>
 #include <vector>
 #include <thread>
-#include <iterator>
 #include <cmath>
+#include <algorithm>
+#include <string>
+#include <optional>
+#include <cassert>
+
+#include <kernels/kernels.hpp>
 
 #include "network.hpp"
 #include "helpers.hpp"
+#include "model_file.hpp"
+#include "checkpoint.hpp"
+#include "streaming.hpp"
+#include "sampler.hpp"
 
 struct ErrorGraph {
     void push_back(std::size_t index, double error) {
@@ -25,19 +35,22 @@ struct ErrorGraph {
     std::vector<double> indices;
 };
 
+template<typename Real>
 struct Test {
-    Instance instance;
-    double output {0.0};
+    std::size_t index {0};  // Of the instance in the training set
+    Real output {0.0};
     bool passed {false};
 };
 
-template<std::size_t Inputs, std::size_t Outputs>
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
 class Learn {
 public:
     struct {
         double learning_rate {0.05};
         double epsilon {0.01};
         unsigned long max_epochs {100'000};
+        bool shuffle {true};  // Visit the training partition in a new order every epoch
+        std::uint64_t seed {0};  // Of the orders, from the first epoch after a reset
     } options;
 
     struct {
@@ -45,41 +58,78 @@ public:
         std::size_t step_index {0};
         double epoch_error {1.0};
 
-        std::vector<double> step_errors;
+        double step_error_sum {0.0};  // Of the steps of this epoch
         ErrorGraph error_graph;
     } learning;
 
     mutable struct {
-        std::vector<Test> tests;
+        std::vector<Test<Real>> tests;
     } testing;
 
-    TrainingSet training_set;
+    TrainingSet<Real> training_set;
+
+    // Train on this instead of the training partition of the training set, if not null; testing
+    // still uses the testing partition
+    StreamingDataset<Real>* stream {nullptr};
+
+    // Written on their own thread while training; disabled by default
+    Checkpoints<Real, Inputs, Outputs> checkpoints;
+
+    void start(network::Network<Real, Inputs, Outputs>& network);
+
+    // Load the network and the progress of a checkpoint, so that start() continues from there;
+    // the normalization stored with it is written, if not null
+    bool resume(network::Network<Real, Inputs, Outputs>& network, const std::string& file_name, Normalization* normalization = nullptr);
+
+    // Train on the calling thread until the epsilon or the maximum epochs are reached
+    void train(network::Network<Real, Inputs, Outputs>& network);
 
-    void start(network::Network<Inputs, Outputs>& network);
     void stop();
     void reset();
-    double test(const network::Network<Inputs, Outputs>& network) const;
     bool is_running() const { return running; }
+
+    // The transform of the inputs trained on, to be stored with the network
+    Normalization get_normalization() const;
+
+    // Any model with run_batch() can be tested, like the network itself or a quantized copy of it
+    template<typename Model>
+    double test(const Model& model) const;
 private:
     mutable struct {
-        std::array<double, Inputs> inputs {};
-        std::array<double, Outputs> outputs {};
-        std::array<double, Outputs> expected_outputs {};
+        const Real* inputs {nullptr};  // Features of the current instance, in the training set or the stream
+        std::array<Real, Outputs> outputs {};
+        std::array<Real, Outputs> expected_outputs {};
+        network::Trace<Real, Outputs> trace;
     } data;
 
+    // Order of the training partition in this epoch
+    Sampler sampler;
+
     std::thread thread;
     bool running = false;
 
+    void prepare_sampler();
+
     // Return true when it should stop
-    bool update(network::Network<Inputs, Outputs>& network);
-    static double calculate_step_error(double* outputs, double* expected_outputs);
-    static double calculate_error_testing(double* outputs, double* expected_outputs);
-    static double calculate_epoch_error(const std::vector<double>& step_errors);
-    void backpropagation(double* outputs, double* expected_outputs, network::Network<Inputs, Outputs>& network) const;
+    bool update(network::Network<Real, Inputs, Outputs>& network);
+    void end_epoch(network::Network<Real, Inputs, Outputs>& network);
+    static double calculate_step_error(Real* outputs, Real* expected_outputs);
+    static double calculate_error_testing(const Real* outputs, const Real* expected_outputs);
+    void backpropagation(Real* outputs, Real* expected_outputs, network::Network<Real, Inputs, Outputs>& network) const;
 };
 
-template<std::size_t Inputs, std::size_t Outputs>
-void Learn<Inputs, Outputs>::start(network::Network<Inputs, Outputs>& network) {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::start(network::Network<Real, Inputs, Outputs>& network) {
+    assert(stream != nullptr || training_set.features.get_columns() == Inputs);
+
+    data.trace = network.create_trace();
+    checkpoints.begin(learning.epoch_index);
+    prepare_sampler();
+
+    if (stream != nullptr) {
+        stream->begin_epoch();
+    }
+
     thread = std::thread([this, &network]() {
         running = true;
 
@@ -93,8 +143,43 @@ void Learn<Inputs, Outputs>::start(network::Network<Inputs, Outputs>& network) {
     });
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-void Learn<Inputs, Outputs>::stop() {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::train(network::Network<Real, Inputs, Outputs>& network) {
+    assert(stream != nullptr || training_set.features.get_columns() == Inputs);
+
+    data.trace = network.create_trace();
+    checkpoints.begin(learning.epoch_index);
+    prepare_sampler();
+
+    if (stream != nullptr) {
+        stream->begin_epoch();
+    }
+
+    while (!update(network)) {}
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+bool Learn<Real, Inputs, Outputs>::resume(
+    network::Network<Real, Inputs, Outputs>& network,
+    const std::string& file_name,
+    Normalization* normalization
+) {
+    network::Progress progress;
+
+    if (!network::load(network, file_name, normalization, &progress)) {
+        return false;
+    }
+
+    reset();
+
+    learning.epoch_index = static_cast<unsigned long>(progress.epoch_index);
+    learning.epoch_error = progress.epoch_error;
+
+    return true;
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::stop() {
     running = false;
 
     if (thread.joinable()) {
@@ -102,54 +187,55 @@ void Learn<Inputs, Outputs>::stop() {
     }
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-void Learn<Inputs, Outputs>::reset() {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::reset() {
     stop();
 
     learning.epoch_index = 0;
     learning.step_index = 0;
     learning.epoch_error = 1.0;
-    learning.step_errors.clear();
+    learning.step_error_sum = 0.0;
     learning.error_graph.clear();
+
+    // Seeded again on the next start
+    sampler.reset(0);
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-double Learn<Inputs, Outputs>::test(const network::Network<Inputs, Outputs>& network) const {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+Normalization Learn<Real, Inputs, Outputs>::get_normalization() const {
+    // Inputs that are not normalized are trained on as they are
+    if (stream != nullptr) {
+        return stream->options.normalize ? stream->options.normalization : Normalization {};
+    }
+
+    return training_set.normalized ? training_set.normalization : Normalization {};
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+template<typename Model>
+double Learn<Real, Inputs, Outputs>::test(const Model& model) const {
     testing.tests.clear();
 
-    std::size_t passed {0};
+    const std::size_t first {training_set.training_instance_count};
+    const std::size_t testing_instance_count {training_set.size() - first};
+    const auto& features {training_set.features};
+
+    assert(features.get_columns() == Inputs);
 
-    for (std::size_t i {training_set.training_instance_count}; i < training_set.data.size(); i++) {
-        const auto& instance = training_set.data[i];
-
-        data.inputs[0] = instance.current_assets;
-        data.inputs[1] = instance.cost_of_goods_sold;
-        data.inputs[2] = instance.depreciation_and_amortization;
-        data.inputs[3] = instance.financial_performance;
-        data.inputs[4] = instance.inventory;
-        data.inputs[5] = instance.net_income;
-        data.inputs[6] = instance.total_receivables;
-        data.inputs[7] = instance.market_value;
-        data.inputs[8] = instance.net_sales;
-        data.inputs[9] = instance.total_assets;
-        data.inputs[10] = instance.total_long_term_debt;
-        data.inputs[11] = instance.earnings_before_interest_and_taxes;
-        data.inputs[12] = instance.gross_profit;
-        data.inputs[13] = instance.total_current_liabilities;
-        data.inputs[14] = instance.retained_earnings;
-        data.inputs[15] = instance.total_revenue;
-        data.inputs[16] = instance.total_liabilities;
-        data.inputs[17] = instance.total_operating_expenses;
-        data.expected_outputs[0] = instance.classification;
-
-        network.run(data.inputs.data(), data.outputs.data());
+    // Evaluate the whole testing partition in one batch, straight from the rows of the set
+    std::vector<Real> outputs(testing_instance_count * Outputs);
 
+    model.run_batch(features.get_data() + first * features.get_stride(), testing_instance_count, outputs.data(), features.get_stride());
+
+    std::size_t passed {0};
+
+    for (std::size_t i {0}; i < testing_instance_count; i++) {
         // The error for this specific network is either 0 or 1
-        const double error = calculate_error_testing(data.outputs.data(), data.expected_outputs.data());
+        const double error = calculate_error_testing(outputs.data() + i * Outputs, training_set.labels.data() + first + i);
 
-        Test test;
-        test.instance = instance;
-        test.output = data.outputs[0];
+        Test<Real> test;
+        test.index = first + i;
+        test.output = outputs[i * Outputs];
 
         if (error == 0.0) {
             passed++;
@@ -159,47 +245,65 @@ double Learn<Inputs, Outputs>::test(const network::Network<Inputs, Outputs>& net
         testing.tests.push_back(test);
     }
 
-    const std::size_t testing_instance_count {training_set.data.size() - training_set.training_instance_count};
-
     return static_cast<double>(passed) / static_cast<double>(testing_instance_count) * 100.0;
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-bool Learn<Inputs, Outputs>::update(network::Network<Inputs, Outputs>& network) {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::prepare_sampler() {
+    // Continuing an epoch keeps its order, unless the training partition changed size
+    if (sampler.size() == training_set.training_instance_count) {
+        return;
+    }
+
+    sampler.seed(options.seed);
+    sampler.reset(training_set.training_instance_count);
+
+    if (options.shuffle) {
+        sampler.shuffle();
+    }
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+bool Learn<Real, Inputs, Outputs>::update(network::Network<Real, Inputs, Outputs>& network) {
     if (learning.epoch_index == options.max_epochs || learning.epoch_error < options.epsilon) {
         return true;
     }
 
     // Retrieve training set instance
-    const auto& instance = training_set.data[learning.step_index];
-
-    // Setup inputs and expected outputs
-    data.inputs[0] = instance.current_assets;
-    data.inputs[1] = instance.cost_of_goods_sold;
-    data.inputs[2] = instance.depreciation_and_amortization;
-    data.inputs[3] = instance.financial_performance;
-    data.inputs[4] = instance.inventory;
-    data.inputs[5] = instance.net_income;
-    data.inputs[6] = instance.total_receivables;
-    data.inputs[7] = instance.market_value;
-    data.inputs[8] = instance.net_sales;
-    data.inputs[9] = instance.total_assets;
-    data.inputs[10] = instance.total_long_term_debt;
-    data.inputs[11] = instance.earnings_before_interest_and_taxes;
-    data.inputs[12] = instance.gross_profit;
-    data.inputs[13] = instance.total_current_liabilities;
-    data.inputs[14] = instance.retained_earnings;
-    data.inputs[15] = instance.total_revenue;
-    data.inputs[16] = instance.total_liabilities;
-    data.inputs[17] = instance.total_operating_expenses;
-    data.expected_outputs[0] = instance.classification;
+    Sample<Real> sample;
+
+    if (stream == nullptr) {
+        sample = training_set.sample(sampler[learning.step_index]);
+    } else {
+        const std::optional<Sample<Real>> next_sample {stream->next()};
+
+        // The end of the stream is known only after its last instance
+        if (!next_sample) {
+            if (stream->get_error() || learning.step_index == 0) {
+                return true;
+            }
+
+            end_epoch(network);
+            stream->begin_epoch();
+
+            return false;
+        }
+
+        sample = *next_sample;
+    }
+
+    assert(sample.features.size() == Inputs);
+
+    // The inputs are the features where they are, without a copy
+    data.inputs = sample.features.data();
+    data.expected_outputs[0] = sample.label;
 
     // Forward pass
-    network.run(data.inputs.data(), data.outputs.data());
+    network.run(data.inputs, data.outputs.data(), data.trace);
 
     // Calculate error
     const double error = calculate_step_error(data.outputs.data(), data.expected_outputs.data());
-    learning.step_errors.push_back(error);
+    learning.step_error_sum += error;
 
     // Learning pass
     backpropagation(data.outputs.data(), data.expected_outputs.data(), network);
@@ -207,113 +311,106 @@ bool Learn<Inputs, Outputs>::update(network::Network<Inputs, Outputs>& network)
     // Next training set instance
     learning.step_index++;
 
-    if (learning.step_index == training_set.training_instance_count) {
-        // Next epoch
+    if (stream == nullptr && learning.step_index == training_set.training_instance_count) {
+        end_epoch(network);
+    }
 
-        learning.epoch_error = calculate_epoch_error(learning.step_errors);
-        learning.step_errors.clear();
+    return false;
+}
 
-        learning.error_graph.push_back(learning.epoch_index, learning.epoch_error);
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::end_epoch(network::Network<Real, Inputs, Outputs>& network) {
+    learning.epoch_error = learning.step_error_sum / static_cast<double>(learning.step_index);
+    learning.step_error_sum = 0.0;
 
-        learning.epoch_index++;
-        learning.step_index = 0;
+    learning.error_graph.push_back(learning.epoch_index, learning.epoch_error);
+
+    learning.epoch_index++;
+    learning.step_index = 0;
+
+    if (stream == nullptr && options.shuffle) {
+        sampler.shuffle();
     }
 
-    return false;
+    checkpoints.end_epoch(network, get_normalization(), {learning.epoch_index, learning.epoch_error});
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-double Learn<Inputs, Outputs>::calculate_step_error(double* outputs, double* expected_outputs) {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+double Learn<Real, Inputs, Outputs>::calculate_step_error(Real* outputs, Real* expected_outputs) {
     double error_sum {0.0};
 
     for (std::size_t i {0}; i < Outputs; i++) {
-        const double error = outputs[i] - expected_outputs[i];
+        const double error = static_cast<double>(outputs[i] - expected_outputs[i]);
         error_sum += error * error;
     }
 
     return error_sum / 2.0;  // FIXME is it right?
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-double Learn<Inputs, Outputs>::calculate_error_testing(double* outputs, double* expected_outputs) {
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+double Learn<Real, Inputs, Outputs>::calculate_error_testing(const Real* outputs, const Real* expected_outputs) {
     double error_sum {0.0};
 
     for (std::size_t i {0}; i < Outputs; i++) {
-        const double error = std::abs(network::functions::binary(outputs[i]) - expected_outputs[i]);
+        const double error = static_cast<double>(std::abs(network::functions::binary(outputs[i]) - expected_outputs[i]));
         error_sum += error;
     }
 
     return error_sum / Outputs;
 }
 
-template<std::size_t Inputs, std::size_t Outputs>
-double Learn<Inputs, Outputs>::calculate_epoch_error(const std::vector<double>& step_errors) {
-    double result_error {0.0};
-
-    for (const double error : step_errors) {
-        result_error += error;
-    }
-
-    result_error /= static_cast<double>(step_errors.size());
-
-    return result_error;
-}
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Learn<Real, Inputs, Outputs>::backpropagation(Real* outputs, Real* expected_outputs, network::Network<Real, Inputs, Outputs>& network) const {
+    auto& trace {data.trace};
+    auto& output_layer {network.output_layer};
+    const std::size_t hidden_layer_count {network.hidden_layers.size()};
+    const Real learning_rate {static_cast<Real>(options.learning_rate)};
 
-template<std::size_t Inputs, std::size_t Outputs>
-void Learn<Inputs, Outputs>::backpropagation(double* outputs, double* expected_outputs, network::Network<Inputs, Outputs>& network) const {
     // Output layer
     for (std::size_t i {0}; i < Outputs; i++) {
-        network::Neuron& neuron {network.output_layer.neurons[i]};
+        const Real layer_error {outputs[i] - expected_outputs[i]};
 
-        const double layer_error {outputs[i] - expected_outputs[i]};
+        trace.deltas[i] = layer_error * network::functions::sigmoid_derivative(outputs[i]);
 
-        neuron.delta = layer_error * network::functions::sigmoid_derivative(outputs[i]);
-
-        for (std::size_t j {0}; j < neuron.n; j++) {
-            auto& last_hidden_layer {network.hidden_layers[network.hidden_layers.size() - 1]};
-
-            const double change {options.learning_rate * last_hidden_layer.neurons[j].output * neuron.delta};
-            neuron.weights[j] -= change;
-        }
+        const Real change {learning_rate * trace.deltas[i]};
+        kernels::axpy(-change, trace.hidden_outputs[hidden_layer_count - 1].data(), output_layer.weights.row(i), output_layer.weights.get_columns());
     }
 
     // Hidden layers
-    for (auto iter = network.hidden_layers.rbegin(); iter != network.hidden_layers.rend(); iter++) {
-        const bool is_last_hidden_layer {iter == network.hidden_layers.rbegin()};
-        const bool is_first_hidden_layer {iter == std::prev(network.hidden_layers.rend())};
+    for (std::size_t l {hidden_layer_count}; l-- > 0;) {
+        auto& layer {network.hidden_layers[l]};
+        auto& deltas {trace.hidden_deltas[l]};
+        const auto& layer_outputs {trace.hidden_outputs[l]};
 
-        for (std::size_t i {0}; i < iter->neurons.size(); i++) {
-            network::Neuron& neuron {iter->neurons[i]};
+        const bool is_last_hidden_layer {l == hidden_layer_count - 1};
+        const bool is_first_hidden_layer {l == 0};
 
-            double layer_error {0.0};
+        const Real* previous_outputs {is_first_hidden_layer ? data.inputs : trace.hidden_outputs[l - 1].data()};
 
-            if (is_last_hidden_layer) {
-                for (auto iter2 = network.output_layer.neurons.begin(); iter2 != network.output_layer.neurons.end(); iter2++) {
-                    network::Neuron& neuron {*iter2};
+        // Every range of neurons depends only on its own columns of the next layer
+        network.split_rows(layer.size(), [&](std::size_t begin, std::size_t end) {
+            // Accumulate the layer errors into the deltas, one row of the next layer at a time
+            std::fill(deltas.begin() + begin, deltas.begin() + end, Real {0.0});
 
-                    layer_error += neuron.weights[i] * neuron.delta;
+            if (is_last_hidden_layer) {
+                for (std::size_t k {0}; k < Outputs; k++) {
+                    kernels::axpy(trace.deltas[k], output_layer.weights.row(k) + begin, deltas.data() + begin, end - begin);
                 }
             } else {
-                for (auto iter2 = std::prev(iter)->neurons.begin(); iter2 != std::prev(iter)->neurons.end(); iter2++) {
-                    network::Neuron& neuron {*iter2};
+                const auto& next_layer {network.hidden_layers[l + 1]};
+                const auto& next_deltas {trace.hidden_deltas[l + 1]};
 
-                    layer_error += neuron.weights[i] * neuron.delta;
+                for (std::size_t k {0}; k < next_layer.size(); k++) {
+                    kernels::axpy(next_deltas[k], next_layer.weights.row(k) + begin, deltas.data() + begin, end - begin);
                 }
             }
 
-            neuron.delta = layer_error * network::functions::tanh_derivative(neuron.output);
+            for (std::size_t i {begin}; i < end; i++) {
+                deltas[i] *= network::functions::tanh_derivative(layer_outputs[i]);
 
-            if (is_first_hidden_layer) {
-                for (std::size_t j {0}; j < neuron.n; j++) {
-                    const double change {options.learning_rate * data.inputs[j] * neuron.delta};
-                    neuron.weights[j] -= change;
-                }
-            } else {
-                for (std::size_t j {0}; j < neuron.n; j++) {
-                    const double change {options.learning_rate * std::next(iter)->neurons[j].output * neuron.delta};
-                    neuron.weights[j] -= change;
-                }
+                const Real change {learning_rate * deltas[i]};
+                kernels::axpy(-change, previous_outputs, layer.weights.row(i), layer.weights.get_columns());
             }
-        }
+        });
     }
 }
@@ -0,0 +1,99 @@
+#include <cstddef>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#else
+    #include <fstream>
+    #include <new>
+#endif
+
+#include "mapped_file.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+
+bool MappedFile::open(const std::string& file_name) {
+    close();
+
+    const int descriptor = ::open(file_name.c_str(), O_RDONLY);
+
+    if (descriptor < 0) {
+        return false;
+    }
+
+    struct stat status {};
+
+    if (fstat(descriptor, &status) < 0 || status.st_size <= 0) {
+        ::close(descriptor);
+        return false;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<std::size_t>(status.st_size), PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+
+    ::close(descriptor);
+
+    if (mapping == MAP_FAILED) {
+        return false;
+    }
+
+    data = mapping;
+    size = static_cast<std::size_t>(status.st_size);
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        munmap(data, size);
+    }
+
+    data = nullptr;
+    size = 0;
+}
+
+#else
+
+bool MappedFile::open(const std::string& file_name) {
+    close();
+
+    std::ifstream stream {file_name, std::ios::binary | std::ios::ate};
+
+    if (!stream.is_open()) {
+        return false;
+    }
+
+    const std::streamoff file_size = stream.tellg();
+
+    if (file_size <= 0) {
+        return false;
+    }
+
+    void* buffer = ::operator new[](static_cast<std::size_t>(file_size), std::align_val_t(ALIGNMENT));
+
+    stream.seekg(0);
+    stream.read(static_cast<char*>(buffer), file_size);
+
+    if (!stream.good()) {
+        ::operator delete[](buffer, std::align_val_t(ALIGNMENT));
+        return false;
+    }
+
+    data = buffer;
+    size = static_cast<std::size_t>(file_size);
+
+    return true;
+}
+
+void MappedFile::close() {
+    if (data != nullptr) {
+        ::operator delete[](data, std::align_val_t(ALIGNMENT));
+    }
+
+    data = nullptr;
+    size = 0;
+}
+
+#endif
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+/*
+    Whole file in memory, aligned to at least 64 bytes. On POSIX it's mapped copy-on-write: the
+    pages are shared with every process mapping the same file, are read from disk only when touched
+    and may be written without changing the file. Elsewhere the file is read into a buffer.
+*/
+
+class MappedFile {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    MappedFile() = default;
+
+    ~MappedFile() {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Return false on any error or for an empty file; an open file is closed first
+    bool open(const std::string& file_name);
+    void close();
+
+    bool is_open() const { return data != nullptr; }
+    unsigned char* get_data() const { return static_cast<unsigned char*>(data); }
+    std::size_t get_size() const { return size; }
+private:
+    void* data = nullptr;
+    std::size_t size = 0;
+};
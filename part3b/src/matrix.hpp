@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <cassert>
+
+/*
+    Row-major matrix stored in one aligned allocation. Every row starts on a cache line boundary,
+    so the stride may be greater than the number of columns. The padding is always zero.
+
+    A view uses memory owned by someone else, like a mapped model file, laid out the same way. It
+    is never freed by the matrix and copying a view makes an owning matrix.
+*/
+
+template<typename Real>
+class Matrix {
+public:
+    static constexpr std::size_t ALIGNMENT = 64;
+
+    Matrix() = default;
+
+    Matrix(std::size_t rows, std::size_t columns)
+        : rows(rows), columns(columns), stride(calculate_stride(columns)) {
+        allocate();
+    }
+
+    // The memory must be aligned, hold rows * calculate_stride(columns) elements and outlive the view
+    static Matrix view(Real* data, std::size_t rows, std::size_t columns) {
+        assert(reinterpret_cast<std::uintptr_t>(data) % ALIGNMENT == 0);
+
+        Matrix matrix;
+        matrix.data = data;
+        matrix.rows = rows;
+        matrix.columns = columns;
+        matrix.stride = calculate_stride(columns);
+        matrix.owning = false;
+
+        return matrix;
+    }
+
+    ~Matrix() {
+        deallocate();
+    }
+
+    Matrix(const Matrix& other)
+        : rows(other.rows), columns(other.columns), stride(other.stride) {
+        allocate();
+
+        if (data != nullptr) {
+            std::memcpy(data, other.data, size() * sizeof(Real));
+        }
+    }
+
+    Matrix& operator=(const Matrix& other) {
+        if (this == &other) {
+            return *this;
+        }
+
+        if (size() != other.size() || !owning) {
+            deallocate();
+
+            rows = other.rows;
+            columns = other.columns;
+            stride = other.stride;
+
+            allocate();
+        } else {
+            rows = other.rows;
+            columns = other.columns;
+            stride = other.stride;
+        }
+
+        if (data != nullptr) {
+            std::memcpy(data, other.data, size() * sizeof(Real));
+        }
+
+        return *this;
+    }
+
+    Matrix(Matrix&& other) noexcept
+        : data(std::exchange(other.data, nullptr)), rows(std::exchange(other.rows, 0)),
+        columns(std::exchange(other.columns, 0)), stride(std::exchange(other.stride, 0)),
+        owning(std::exchange(other.owning, true)) {}
+
+    Matrix& operator=(Matrix&& other) noexcept {
+        if (this == &other) {
+            return *this;
+        }
+
+        deallocate();
+
+        data = std::exchange(other.data, nullptr);
+        rows = std::exchange(other.rows, 0);
+        columns = std::exchange(other.columns, 0);
+        stride = std::exchange(other.stride, 0);
+        owning = std::exchange(other.owning, true);
+
+        return *this;
+    }
+
+    Real* row(std::size_t i) {
+        assert(i < rows);
+
+        return data + i * stride;
+    }
+
+    const Real* row(std::size_t i) const {
+        assert(i < rows);
+
+        return data + i * stride;
+    }
+
+    Real& operator()(std::size_t i, std::size_t j) {
+        assert(j < columns);
+
+        return row(i)[j];
+    }
+
+    Real operator()(std::size_t i, std::size_t j) const {
+        assert(j < columns);
+
+        return row(i)[j];
+    }
+
+    Real* get_data() { return data; }
+    const Real* get_data() const { return data; }
+    std::size_t get_rows() const { return rows; }
+    std::size_t get_columns() const { return columns; }
+    std::size_t get_stride() const { return stride; }
+    bool is_view() const { return !owning; }
+
+    static constexpr std::size_t calculate_stride(std::size_t columns) {
+        constexpr std::size_t per_line = ALIGNMENT / sizeof(Real);
+
+        return (columns + per_line - 1) / per_line * per_line;
+    }
+private:
+    std::size_t size() const {
+        return rows * stride;
+    }
+
+    void allocate() {
+        owning = true;
+
+        if (size() == 0) {
+            data = nullptr;
+            return;
+        }
+
+        data = static_cast<Real*>(::operator new[](size() * sizeof(Real), std::align_val_t(ALIGNMENT)));
+        std::memset(data, 0, size() * sizeof(Real));
+    }
+
+    void deallocate() {
+        if (data != nullptr && owning) {
+            ::operator delete[](data, std::align_val_t(ALIGNMENT));
+        }
+
+        data = nullptr;
+    }
+
+    Real* data = nullptr;
+    std::size_t rows = 0;
+    std::size_t columns = 0;
+    std::size_t stride = 0;
+    bool owning = true;
+};
@@ -0,0 +1,435 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <cstdio>
+#include <filesystem>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+#include "network.hpp"
+#include "matrix.hpp"
+#include "helpers.hpp"
+#include "mapped_file.hpp"
+
+/*
+    Binary file for a trained network, in the byte order of the machine. Everything is laid out
+    the way it is in memory, so that a mapped file can be used in place:
+
+    header (64 bytes)
+        "NN3B", version, size of Real, inputs, outputs, hidden layer count, hidden activation,
+        output activation (all uint32), offset of the normalization, offset of the layer table,
+        size of the file, offset of the progress or zero (all uint64)
+    normalization, aligned to 64 bytes
+        minimum and maximum of every input (double), from the statistics of the training set
+    progress, aligned to 64 bytes, only in checkpoints
+        epoch index (uint64), epoch error (double)
+    layer table, aligned to 64 bytes
+        rows, columns, stride (all uint32), reserved, offset of the weights (uint64) for every
+        hidden layer, then for the output layer
+    weights of every layer, aligned to 64 bytes
+        rows * stride Reals, the padding of every row being zero, exactly like a Matrix
+
+    A file written on a machine with the other byte order fails on the version.
+*/
+
+namespace network {
+    inline constexpr std::array<char, 4> MODEL_MAGIC { 'N', 'N', '3', 'B' };
+    inline constexpr std::uint32_t MODEL_VERSION = 2;
+
+    // Where training was when a checkpoint was taken, so that it can be resumed from there
+    struct Progress {
+        std::uint64_t epoch_index = 0;
+        double epoch_error = 1.0;
+    };
+
+    // The activations the networks are hardcoded to, stored so that the file describes itself
+    enum class ModelActivation : std::uint32_t {
+        Tanh = 1,
+        Sigmoid = 2
+    };
+
+    // Return false on any I/O error; the normalization is the one of the inputs the network was
+    // trained on, so that it's applied the same way to new inputs; the progress is stored only if
+    // not null. The file is written next to the destination and renamed over it, so processes
+    // that have the old file mapped keep using it and never see a half written model
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    bool save(
+        const Network<Real, Inputs, Outputs>& network,
+        const std::string& file_name,
+        const Normalization& normalization,
+        const Progress* progress = nullptr
+    );
+
+    // Return false and leave the network unchanged, if the file is invalid or made for another
+    // network; the weights are copied and the normalization and the progress are written, if not
+    // null (the progress only if the file has one)
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    bool load(
+        Network<Real, Inputs, Outputs>& network,
+        const std::string& file_name,
+        Normalization* normalization = nullptr,
+        Progress* progress = nullptr
+    );
+
+    // Same, but the weights are views into the mapped file, which must outlive the network; only
+    // the header and the layer table are read, whatever the size of the model
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    bool load(Network<Real, Inputs, Outputs>& network, const MappedFile& file, Normalization* normalization = nullptr);
+
+    namespace model_file {
+        inline constexpr std::size_t ALIGNMENT = 64;
+
+        struct Header {
+            std::array<char, 4> magic {};
+            std::uint32_t version = 0;
+            std::uint32_t real_size = 0;
+            std::uint32_t inputs = 0;
+            std::uint32_t outputs = 0;
+            std::uint32_t hidden_layer_count = 0;
+            std::uint32_t hidden_activation = 0;
+            std::uint32_t output_activation = 0;
+            std::uint64_t normalization_offset = 0;
+            std::uint64_t layers_offset = 0;
+            std::uint64_t file_size = 0;
+            std::uint64_t progress_offset = 0;
+        };
+
+        struct LayerEntry {
+            std::uint32_t rows = 0;
+            std::uint32_t columns = 0;
+            std::uint32_t stride = 0;
+            std::uint32_t reserved = 0;
+            std::uint64_t offset = 0;
+        };
+
+        static_assert(sizeof(Header) == 64);
+        static_assert(sizeof(LayerEntry) == 24);
+        static_assert(sizeof(Normalization) == 2 * 18 * sizeof(double));
+        static_assert(sizeof(Progress) == 16);
+
+        inline constexpr std::uint64_t align(std::uint64_t offset) {
+            return (offset + ALIGNMENT - 1) / ALIGNMENT * ALIGNMENT;
+        }
+
+        // Make the written file durable, then replace the destination with it in one step
+        inline bool commit(const std::string& temporary_file_name, const std::string& file_name) {
+#if defined(__unix__) || defined(__APPLE__)
+            const int file = ::open(temporary_file_name.c_str(), O_RDONLY);
+
+            if (file < 0) {
+                return false;
+            }
+
+            const bool synced = fsync(file) == 0;
+            ::close(file);
+
+            if (!synced || std::rename(temporary_file_name.c_str(), file_name.c_str()) != 0) {
+                return false;
+            }
+
+            // The rename itself is durable only when the directory is
+            std::filesystem::path directory_name = std::filesystem::path(file_name).parent_path();
+
+            if (directory_name.empty()) {
+                directory_name = ".";
+            }
+
+            const int directory = ::open(directory_name.c_str(), O_RDONLY);
+
+            if (directory < 0) {
+                return false;
+            }
+
+            const bool directory_synced = fsync(directory) == 0;
+            ::close(directory);
+
+            return directory_synced;
+#else
+            std::error_code error;
+            std::filesystem::rename(temporary_file_name, file_name, error);
+
+            return !error;
+#endif
+        }
+
+        // True, if [offset, offset + size) lies inside a file of file_size bytes
+        inline bool contains(std::uint64_t file_size, std::uint64_t offset, std::uint64_t size) {
+            return offset <= file_size && size <= file_size - offset;
+        }
+
+        template<typename Real>
+        void add_entry(std::vector<LayerEntry>& entries, std::uint64_t& offset, const Matrix<Real>& weights) {
+            LayerEntry entry;
+            entry.rows = static_cast<std::uint32_t>(weights.get_rows());
+            entry.columns = static_cast<std::uint32_t>(weights.get_columns());
+            entry.stride = static_cast<std::uint32_t>(weights.get_stride());
+            entry.offset = offset;
+
+            entries.push_back(entry);
+
+            offset = align(offset + weights.get_rows() * weights.get_stride() * sizeof(Real));
+        }
+
+        inline bool write_padding(std::ofstream& stream, std::uint64_t offset) {
+            static constexpr std::array<char, ALIGNMENT> ZEROS {};
+
+            const std::uint64_t position = static_cast<std::uint64_t>(stream.tellp());
+
+            if (position > offset) {
+                return false;
+            }
+
+            stream.write(ZEROS.data(), static_cast<std::streamsize>(offset - position));
+
+            return stream.good();
+        }
+
+        // Check the header and the layer table against the file and the network, then make every
+        // layer from the weights in the file, either as views or as copies
+        template<typename Real, std::size_t Inputs, std::size_t Outputs>
+        bool read(
+            Network<Real, Inputs, Outputs>& network,
+            unsigned char* bytes,
+            std::size_t size,
+            bool view,
+            Normalization* normalization,
+            Progress* progress
+        ) {
+            Header header;
+
+            if (size < sizeof(header)) {
+                return false;
+            }
+
+            std::memcpy(&header, bytes, sizeof(header));
+
+            if (header.magic != MODEL_MAGIC || header.version != MODEL_VERSION || header.file_size != size) {
+                return false;
+            }
+
+            if (header.real_size != sizeof(Real) || header.inputs != Inputs || header.outputs != Outputs) {
+                return false;
+            }
+
+            if (header.hidden_activation != static_cast<std::uint32_t>(ModelActivation::Tanh)) {
+                return false;
+            }
+
+            if (header.output_activation != static_cast<std::uint32_t>(ModelActivation::Sigmoid)) {
+                return false;
+            }
+
+            const std::uint64_t layer_count = std::uint64_t(header.hidden_layer_count) + 1;
+
+            if (header.hidden_layer_count == 0 || header.layers_offset % alignof(LayerEntry) != 0) {
+                return false;
+            }
+
+            if (!contains(size, header.normalization_offset, sizeof(Normalization))) {
+                return false;
+            }
+
+            if (!contains(size, header.layers_offset, layer_count * sizeof(LayerEntry))) {
+                return false;
+            }
+
+            if (header.progress_offset != 0 && !contains(size, header.progress_offset, sizeof(Progress))) {
+                return false;
+            }
+
+            const LayerEntry* entries = reinterpret_cast<const LayerEntry*>(bytes + header.layers_offset);
+
+            // Layers chain from the inputs to the outputs and lie, aligned, inside the file
+            std::size_t current_inputs = Inputs;
+
+            for (std::uint64_t i = 0; i < layer_count; i++) {
+                const LayerEntry& entry = entries[i];
+                const bool output = i == layer_count - 1;
+
+                if (entry.rows == 0 || entry.columns != current_inputs || (output && entry.rows != Outputs)) {
+                    return false;
+                }
+
+                if (entry.stride != Matrix<Real>::calculate_stride(entry.columns) || entry.offset % ALIGNMENT != 0) {
+                    return false;
+                }
+
+                if (!contains(size, entry.offset, std::uint64_t(entry.rows) * entry.stride * sizeof(Real))) {
+                    return false;
+                }
+
+                current_inputs = entry.rows;
+            }
+
+            const auto make_weights = [bytes, view](const LayerEntry& entry) {
+                Real* data = reinterpret_cast<Real*>(bytes + entry.offset);
+
+                if (view) {
+                    return Matrix<Real>::view(data, entry.rows, entry.columns);
+                }
+
+                Matrix<Real> weights {entry.rows, entry.columns};
+                std::memcpy(weights.get_data(), data, std::size_t(entry.rows) * entry.stride * sizeof(Real));
+
+                return weights;
+            };
+
+            std::vector<HiddenLayer<Real>> hidden_layers;
+            hidden_layers.reserve(header.hidden_layer_count);
+
+            for (std::uint32_t i = 0; i < header.hidden_layer_count; i++) {
+                HiddenLayer<Real> layer;
+                layer.weights = make_weights(entries[i]);
+
+                hidden_layers.push_back(std::move(layer));
+            }
+
+            network.hidden_layers = std::move(hidden_layers);
+            network.output_layer.weights = make_weights(entries[header.hidden_layer_count]);
+
+            if (normalization != nullptr) {
+                std::memcpy(normalization, bytes + header.normalization_offset, sizeof(Normalization));
+            }
+
+            if (progress != nullptr && header.progress_offset != 0) {
+                std::memcpy(progress, bytes + header.progress_offset, sizeof(Progress));
+            }
+
+            return true;
+        }
+
+        template<typename Real, std::size_t Inputs, std::size_t Outputs>
+        bool write(
+            const Network<Real, Inputs, Outputs>& network,
+            const std::string& file_name,
+            const Header& header,
+            const std::vector<LayerEntry>& entries,
+            const Normalization& normalization,
+            const Progress* progress
+        ) {
+            std::ofstream stream {file_name, std::ios::binary | std::ios::trunc};
+
+            if (!stream.is_open()) {
+                return false;
+            }
+
+            bool result = true;
+
+            stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+            result = result && model_file::write_padding(stream, header.normalization_offset);
+            stream.write(reinterpret_cast<const char*>(&normalization), sizeof(normalization));
+
+            if (progress != nullptr) {
+                result = result && model_file::write_padding(stream, header.progress_offset);
+                stream.write(reinterpret_cast<const char*>(progress), sizeof(*progress));
+            }
+
+            result = result && model_file::write_padding(stream, header.layers_offset);
+            stream.write(reinterpret_cast<const char*>(entries.data()), static_cast<std::streamsize>(entries.size() * sizeof(model_file::LayerEntry)));
+
+            // The padding of the matrices is zero, so the weights are written exactly as they are in memory
+            const auto write_weights = [&stream](const model_file::LayerEntry& entry, const Matrix<Real>& weights) {
+                if (!model_file::write_padding(stream, entry.offset)) {
+                    return false;
+                }
+
+                stream.write(reinterpret_cast<const char*>(weights.get_data()), static_cast<std::streamsize>(weights.get_rows() * weights.get_stride() * sizeof(Real)));
+
+                return stream.good();
+            };
+
+            for (std::size_t i = 0; i < network.hidden_layers.size(); i++) {
+                result = result && write_weights(entries[i], network.hidden_layers[i].weights);
+            }
+
+            result = result && write_weights(entries.back(), network.output_layer.weights);
+            result = result && model_file::write_padding(stream, header.file_size);
+
+            stream.flush();
+
+            return result && stream.good();
+        }
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    bool save(
+        const Network<Real, Inputs, Outputs>& network,
+        const std::string& file_name,
+        const Normalization& normalization,
+        const Progress* progress
+    ) {
+        model_file::Header header;
+        header.magic = MODEL_MAGIC;
+        header.version = MODEL_VERSION;
+        header.real_size = sizeof(Real);
+        header.inputs = Inputs;
+        header.outputs = Outputs;
+        header.hidden_layer_count = static_cast<std::uint32_t>(network.hidden_layers.size());
+        header.hidden_activation = static_cast<std::uint32_t>(ModelActivation::Tanh);
+        header.output_activation = static_cast<std::uint32_t>(ModelActivation::Sigmoid);
+        header.normalization_offset = model_file::align(sizeof(header));
+        header.progress_offset = progress != nullptr ? model_file::align(header.normalization_offset + sizeof(Normalization)) : 0;
+        header.layers_offset = model_file::align(
+            progress != nullptr ? header.progress_offset + sizeof(Progress) : header.normalization_offset + sizeof(Normalization)
+        );
+
+        const std::size_t layer_count = network.hidden_layers.size() + 1;
+
+        std::vector<model_file::LayerEntry> entries;
+        entries.reserve(layer_count);
+
+        std::uint64_t offset = model_file::align(header.layers_offset + layer_count * sizeof(model_file::LayerEntry));
+
+        for (const HiddenLayer<Real>& layer : network.hidden_layers) {
+            model_file::add_entry(entries, offset, layer.weights);
+        }
+
+        model_file::add_entry(entries, offset, network.output_layer.weights);
+
+        header.file_size = offset;
+
+        // Never truncated in place, as the file may be mapped by a loader
+        const std::string temporary_file_name = file_name + ".tmp";
+
+        if (!model_file::write(network, temporary_file_name, header, entries, normalization, progress)) {
+            std::error_code error;
+            std::filesystem::remove(temporary_file_name, error);
+
+            return false;
+        }
+
+        return model_file::commit(temporary_file_name, file_name);
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    bool load(Network<Real, Inputs, Outputs>& network, const std::string& file_name, Normalization* normalization, Progress* progress) {
+        MappedFile file;
+
+        if (!file.open(file_name)) {
+            return false;
+        }
+
+        return model_file::read(network, file.get_data(), file.get_size(), false, normalization, progress);
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    bool load(Network<Real, Inputs, Outputs>& network, const MappedFile& file, Normalization* normalization) {
+        if (!file.is_open()) {
+            return false;
+        }
+
+        return model_file::read(network, file.get_data(), file.get_size(), true, normalization, nullptr);
+    }
+}
@@ -9,57 +9,83 @@
 #include <utility>
 #include <cassert>
 #include <cmath>
+#include <algorithm>
+#include <type_traits>
+
+#include <kernels/kernels.hpp>
 
 #include "helpers.hpp"
+#include "matrix.hpp"
+#include "thread_pool.hpp"
 
 namespace network {
     namespace functions {
-        constexpr double sum(const double* inputs, const double* weights, std::size_t size) {
-            double result = 0.0;
+        template<typename Real>
+        inline Real sum(const Real* inputs, const Real* weights, std::size_t size) {
+            return kernels::dot(inputs, weights, size);
+        }
 
-            for (std::size_t i = 0; i < size; i++) {
-                result += inputs[i] * weights[i];
+        // Multiply a row-major matrix by a vector; consecutive rows are stride elements apart
+        template<typename Real>
+        inline void matrix_vector(const Real* matrix, std::size_t stride, const Real* vector, Real* result, std::size_t rows, std::size_t columns) {
+            for (std::size_t i = 0; i < rows; i++) {
+                result[i] = sum(vector, matrix + i * stride, columns);
             }
-
-            return result;
         }
 
-        constexpr double sigmoid(double x) {
-            constexpr double e = std::numbers::e_v<double>;
-            constexpr double one = 1.0;
+        // Multiply the rows of a by the transpose of b, as in result = a * b^T; b holds one neuron per row
+        template<typename Real>
+        inline void matrix_matrix(
+            const Real* a, std::size_t a_stride, std::size_t a_rows,
+            const Real* b, std::size_t b_stride, std::size_t b_rows,
+            std::size_t columns,
+            Real* result, std::size_t result_stride
+        ) {
+            // A single row gains nothing from packing the weights
+            if (a_rows == 1) {
+                matrix_vector(b, b_stride, a, result, b_rows, columns);
+                return;
+            }
 
-            return one / (one + std::pow(e, -x));
+            kernels::gemm(a_rows, b_rows, columns, a, a_stride, b, b_stride, result, result_stride);
         }
 
-        constexpr double sigmoid_derivative(double x) {
-            return x * (1.0 - x);
-        }
+        template<typename Real>
+        constexpr Real sigmoid(Real x) {
+            constexpr Real one = 1.0;
 
-        constexpr double tanh(double x) {
-            constexpr double e = std::numbers::e_v<double>;
+            return one / (one + std::exp(-x));
+        }
 
-            const double a = std::pow(e, x);
-            const double b = std::pow(e, -x);
+        template<typename Real>
+        constexpr Real sigmoid_derivative(Real x) {
+            return x * (static_cast<Real>(1.0) - x);
+        }
 
-            return (a - b) / (a + b);
+        template<typename Real>
+        constexpr Real tanh(Real x) {
+            return std::tanh(x);
         }
 
-        constexpr double tanh_derivative(double x) {
-            const double y = tanh(x);
+        template<typename Real>
+        constexpr Real tanh_derivative(Real x) {
+            const Real y = tanh(x);
 
-            return 1.0 - y * y;
+            return static_cast<Real>(1.0) - y * y;
         }
 
-        constexpr double binary(double x) {
-            if (x >= 0.5) {
+        template<typename Real>
+        constexpr Real binary(Real x) {
+            if (x >= static_cast<Real>(0.5)) {
                 return 1.0;
             } else {
                 return 0.0;
             }
         }
 
-        constexpr double binary2(double x) {
-            if (x >= 0.0) {
+        template<typename Real>
+        constexpr Real binary2(Real x) {
+            if (x >= static_cast<Real>(0.0)) {
                 return 1.0;
             } else {
                 return -1.0;
@@ -67,30 +93,66 @@ namespace network {
         }
     }
 
-    struct Neuron {
-        double* weights = nullptr;
-        std::size_t n = 0;
-        double output = 0.0;
-        double delta = 0.0;
-    };
-
+    template<typename Real>
     struct HiddenLayer {
-        std::vector<Neuron> neurons;
+        Matrix<Real> weights;  // One row for every neuron
+
+        std::size_t size() const {
+            return weights.get_rows();
+        }
     };
 
-    template<std::size_t Size>
+    template<typename Real, std::size_t Size>
     struct OutputLayer {
-        std::array<Neuron, Size> neurons {};
+        Matrix<Real> weights;  // One row for every neuron
+
+        constexpr std::size_t size() const {
+            return Size;
+        }
     };
 
     struct HiddenLayers {
         std::vector<std::size_t> layers;
     };
 
-    template<std::size_t Inputs, std::size_t Outputs>
+    // Layers with at least threshold neurons are split across the pool; without a pool everything runs on the calling thread
+    struct Parallelism {
+        ThreadPool* pool = nullptr;
+        std::size_t threshold = 512;
+    };
+
+    // Ping-pong activation buffers for the forward pass, sized once from the topology of a network
+    template<typename Real>
+    struct Workspace {
+        std::vector<Real> front;
+        std::vector<Real> back;
+        std::size_t width = 0;  // Elements of one row, the size of the largest layer
+        std::size_t rows = 0;  // Rows that are evaluated together
+    };
+
+    /*
+        Outputs and deltas of every layer, recorded by a forward pass and used by backpropagation.
+        The network itself holds only weights, so any number of threads can run it at the same time,
+        as long as each one has its own workspace or trace.
+    */
+    template<typename Real, std::size_t Outputs>
+    struct Trace {
+        std::vector<std::vector<Real>> hidden_outputs;
+        std::vector<std::vector<Real>> hidden_deltas;
+        std::array<Real, Outputs> outputs {};
+        std::array<Real, Outputs> deltas {};
+    };
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
     class Network {
     public:
-        void run(const double* inputs, double* outputs) const;
+        void run(const Real* inputs, Real* outputs, Workspace<Real>& workspace) const;
+        void run(const Real* inputs, Real* outputs, Trace<Real, Outputs>& trace) const;
+        // Rows of the inputs are inputs_stride apart, so the rows of a matrix can be run in place
+        void run_batch(const Real* inputs, std::size_t batch, Real* outputs, std::size_t inputs_stride = Inputs) const;
+        void run_batch(const Real* inputs, std::size_t batch, Real* outputs, Workspace<Real>& workspace, std::size_t inputs_stride = Inputs) const;
+        Workspace<Real> create_workspace() const;
+        Trace<Real, Outputs> create_trace() const;
         void setup(HiddenLayers&& hidden_layers);
         void initialize_neurons();
 
@@ -102,119 +164,214 @@ namespace network {
             return Outputs;
         }
 
-        OutputLayer<Outputs> output_layer;
-        std::vector<HiddenLayer> hidden_layers;
+        // Call function(begin, end) over ranges of the rows of a layer, in parallel if the layer is wide enough
+        template<typename Function>
+        void split_rows(std::size_t rows, const Function& function) const;
+
+        OutputLayer<Real, Outputs> output_layer;
+        std::vector<HiddenLayer<Real>> hidden_layers;
+        Parallelism parallelism;
     private:
+        // Rows of a batch that are pushed through all the layers together
+        static constexpr std::size_t BATCH_BLOCK = 64;
+
         void clear();
-        void allocate_current_inputs(double** inputs, std::size_t* n, const std::vector<Neuron>& neurons) const;
-        void process_neuron_tanh(const Neuron& neuron, const double* inputs, std::size_t n)const ;
-        void process_neuron_sigmoid(const Neuron& neuron, const double* inputs, std::size_t n)const ;
+        std::size_t max_layer_size() const;
+        void process_layer_tanh(const Matrix<Real>& weights, const Real* inputs, Real* outputs) const;
+        void process_layer_sigmoid(const Matrix<Real>& weights, const Real* inputs, Real* outputs) const;
     };
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::run(const double* inputs, double* outputs) const {
-        std::size_t i = 0;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::run(const Real* inputs, Real* outputs, Workspace<Real>& workspace) const {
+        assert(workspace.width >= max_layer_size());
 
-        auto& layer = hidden_layers[i];
+        const Real* current_inputs = inputs;
+        Real* current_outputs = workspace.front.data();
+        Real* next_outputs = workspace.back.data();
 
-        for (const Neuron& neuron : layer.neurons) {
-            process_neuron_tanh(neuron, inputs, Inputs);
+        for (const HiddenLayer<Real>& layer : hidden_layers) {
+            process_layer_tanh(layer.weights, current_inputs, current_outputs);
+            current_inputs = current_outputs;
+            std::swap(current_outputs, next_outputs);
         }
 
-        std::size_t current_n = 0;
-        double* current_inputs = nullptr;
-        allocate_current_inputs(&current_inputs, &current_n, hidden_layers[i].neurons);
+        process_layer_sigmoid(output_layer.weights, current_inputs, outputs);
+    }
 
-        i++;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::run(const Real* inputs, Real* outputs, Trace<Real, Outputs>& trace) const {
+        assert(trace.hidden_outputs.size() == hidden_layers.size());
 
-        for (; i < hidden_layers.size(); i++) {
-            auto& layer = hidden_layers[i];
+        const Real* current_inputs = inputs;
 
-            for (const Neuron& neuron : layer.neurons) {
-                process_neuron_tanh(neuron, current_inputs, current_n);
-            }
+        for (std::size_t i = 0; i < hidden_layers.size(); i++) {
+            process_layer_tanh(hidden_layers[i].weights, current_inputs, trace.hidden_outputs[i].data());
+            current_inputs = trace.hidden_outputs[i].data();
+        }
+
+        process_layer_sigmoid(output_layer.weights, current_inputs, trace.outputs.data());
 
-            allocate_current_inputs(&current_inputs, &current_n, hidden_layers[i].neurons);
+        for (std::size_t j = 0; j < Outputs; j++) {
+            outputs[j] = trace.outputs[j];
         }
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::run_batch(const Real* inputs, std::size_t batch, Real* outputs, std::size_t inputs_stride) const {
+        Workspace<Real> workspace = create_workspace();
+
+        run_batch(inputs, batch, outputs, workspace, inputs_stride);
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::run_batch(const Real* inputs, std::size_t batch, Real* outputs, Workspace<Real>& workspace, std::size_t inputs_stride) const {
+        // Inputs are batch rows of Inputs values, outputs are batch rows of Outputs values
 
-        for (const Neuron& neuron : output_layer.neurons) {
-            process_neuron_sigmoid(neuron, current_inputs, current_n);
+        assert(workspace.width >= max_layer_size());
+        assert(inputs_stride >= Inputs);
+
+        const std::size_t width = workspace.width;
+
+        for (std::size_t begin = 0; begin < batch; begin += workspace.rows) {
+            const std::size_t rows = std::min(workspace.rows, batch - begin);
+
+            const Real* current_inputs = inputs + begin * inputs_stride;
+            std::size_t current_stride = inputs_stride;
+            Real* current_outputs = workspace.front.data();
+            Real* next_outputs = workspace.back.data();
+
+            for (const HiddenLayer<Real>& layer : hidden_layers) {
+                split_rows(layer.size(), [&](std::size_t row_begin, std::size_t row_end) {
+                    functions::matrix_matrix(
+                        current_inputs, current_stride, rows,
+                        layer.weights.row(row_begin), layer.weights.get_stride(), row_end - row_begin,
+                        layer.weights.get_columns(),
+                        current_outputs + row_begin, width
+                    );
+
+                    for (std::size_t r = 0; r < rows; r++) {
+                        kernels::tanh(current_outputs + r * width + row_begin, row_end - row_begin);
+                    }
+                });
+
+                current_inputs = current_outputs;
+                current_stride = width;
+                std::swap(current_outputs, next_outputs);
+            }
+
+            Real* block_outputs = outputs + begin * Outputs;
+
+            functions::matrix_matrix(
+                current_inputs, current_stride, rows,
+                output_layer.weights.get_data(), output_layer.weights.get_stride(), Outputs,
+                output_layer.weights.get_columns(),
+                block_outputs, Outputs
+            );
+
+            kernels::sigmoid(block_outputs, rows * Outputs);
         }
+    }
 
-        // Delete last allocation
-        delete[] current_inputs;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    Workspace<Real> Network<Real, Inputs, Outputs>::create_workspace() const {
+        Workspace<Real> workspace;
+        workspace.width = max_layer_size();
+        workspace.rows = BATCH_BLOCK;
+        workspace.front.resize(workspace.width * workspace.rows);
+        workspace.back.resize(workspace.width * workspace.rows);
 
-        for (std::size_t j = 0; j < output_layer.neurons.size(); j++) {
-            outputs[j] = output_layer.neurons[j].output;
+        return workspace;
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    Trace<Real, Outputs> Network<Real, Inputs, Outputs>::create_trace() const {
+        Trace<Real, Outputs> trace;
+
+        for (const HiddenLayer<Real>& layer : hidden_layers) {
+            trace.hidden_outputs.emplace_back(layer.size());
+            trace.hidden_deltas.emplace_back(layer.size());
         }
+
+        return trace;
     }
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::setup(HiddenLayers&& hidden_layers) {
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::setup(HiddenLayers&& hidden_layers) {
         static_assert(Inputs > 0);
         static_assert(Outputs > 0);
+        static_assert(std::is_same_v<Real, float> || std::is_same_v<Real, double>);
         assert(!hidden_layers.layers.empty());
 
         clear();
 
         this->hidden_layers.reserve(hidden_layers.layers.size());
 
+        std::size_t current_inputs = Inputs;
+
         for (std::size_t neuron_count : hidden_layers.layers) {
-            HiddenLayer layer;
-            layer.neurons.resize(neuron_count);
+            HiddenLayer<Real> layer;
+            layer.weights = Matrix<Real>(neuron_count, current_inputs);
 
             this->hidden_layers.push_back(std::move(layer));
+
+            current_inputs = neuron_count;
         }
 
+        output_layer.weights = Matrix<Real>(Outputs, current_inputs);
+
         initialize_neurons();
     }
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::initialize_neurons() {
-        std::size_t current_inputs = Inputs;
-
-        for (HiddenLayer& layer : hidden_layers) {
-            for (Neuron& neuron : layer.neurons) {
-                reallocate_double_array_random(&neuron.weights, &neuron.n, current_inputs);
-            }
-
-            current_inputs = layer.neurons.size();
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::initialize_neurons() {
+        for (HiddenLayer<Real>& layer : hidden_layers) {
+            randomize_matrix(layer.weights);
         }
 
-        for (Neuron& neuron : output_layer.neurons) {
-            reallocate_double_array_random(&neuron.weights, &neuron.n, current_inputs);
-        }
+        randomize_matrix(output_layer.weights);
     }
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::clear() {
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::clear() {
         output_layer = {};
         hidden_layers.clear();
     }
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::allocate_current_inputs(double** inputs, std::size_t* n, const std::vector<Neuron>& neurons) const {
-        delete[] *inputs;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    std::size_t Network<Real, Inputs, Outputs>::max_layer_size() const {
+        std::size_t size = Outputs;
+
+        for (const HiddenLayer<Real>& layer : hidden_layers) {
+            size = std::max(size, layer.size());
+        }
 
-        *n = neurons.size();
-        *inputs = new double[*n];
+        return size;
+    }
 
-        for (std::size_t i = 0; i < *n; i++) {
-            (*inputs)[i] = neurons[i].output;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    template<typename Function>
+    void Network<Real, Inputs, Outputs>::split_rows(std::size_t rows, const Function& function) const {
+        if (parallelism.pool == nullptr || rows < parallelism.threshold) {
+            function(0, rows);
+            return;
         }
+
+        parallelism.pool->parallel_for(rows, function);
     }
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::process_neuron_tanh(const Neuron& neuron, const double* inputs, std::size_t n) const {
-        const double global_input = functions::sum(inputs, neuron.weights, n);
-        const double activation = functions::tanh(global_input);
-        const_cast<Neuron&>(neuron).output = activation;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::process_layer_tanh(const Matrix<Real>& weights, const Real* inputs, Real* outputs) const {
+        split_rows(weights.get_rows(), [&](std::size_t begin, std::size_t end) {
+            functions::matrix_vector(weights.row(begin), weights.get_stride(), inputs, outputs + begin, end - begin, weights.get_columns());
+
+            kernels::tanh(outputs + begin, end - begin);
+        });
     }
 
-    template<std::size_t Inputs, std::size_t Outputs>
-    void Network<Inputs, Outputs>::process_neuron_sigmoid(const Neuron& neuron, const double* inputs, std::size_t n) const {
-        const double global_input = functions::sum(inputs, neuron.weights, n);
-        const double activation = functions::sigmoid(global_input);
-        const_cast<Neuron&>(neuron).output = activation;
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void Network<Real, Inputs, Outputs>::process_layer_sigmoid(const Matrix<Real>& weights, const Real* inputs, Real* outputs) const {
+        functions::matrix_vector(weights.get_data(), weights.get_stride(), inputs, outputs, weights.get_rows(), weights.get_columns());
+
+        kernels::sigmoid(outputs, weights.get_rows());
     }
 }
@@ -0,0 +1,8 @@
+#pragma once
+
+// Floating point type of the application's network; the nn3b_f32 target defines NN3B_FLOAT
+#ifdef NN3B_FLOAT
+    using Precision = float;
+#else
+    using Precision = double;
+#endif
@@ -0,0 +1,272 @@
+#pragma once
+
+#include <vector>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <utility>
+#include <span>
+#include <cassert>
+
+#include <kernels/kernels.hpp>
+
+#include "network.hpp"
+#include "helpers.hpp"
+#include "matrix.hpp"
+
+/*
+    Int8 copy of a trained network, for inference only.
+
+    The weights are quantized symmetrically, with one scale for every row or one for the whole
+    layer. Each layer quantizes its inputs with a scale calibrated from the largest input seen
+    while running the float network on the first instances of the training set. The products are
+    accumulated in int32 and converted back to float with the two scales; the activations are
+    done in float.
+*/
+
+namespace network {
+    enum class Granularity {
+        Layer,  // One scale for all the weights of a layer
+        Row  // One scale for the weights of every neuron
+    };
+
+    struct QuantizedLayer {
+        Matrix<std::int8_t> weights;  // One row for every neuron
+        std::vector<float> scales;  // One for every row, even when they are all the same
+        float input_scale = 1.0f;
+
+        std::size_t size() const {
+            return weights.get_rows();
+        }
+    };
+
+    struct QuantizedWorkspace {
+        std::vector<float> front;
+        std::vector<float> back;
+        std::vector<std::int8_t> inputs;  // Quantized inputs of the current layer
+    };
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    class QuantizedNetwork {
+    public:
+        void run(const Real* inputs, Real* outputs, QuantizedWorkspace& workspace) const;
+        void run_batch(const Real* inputs, std::size_t batch, Real* outputs, std::size_t inputs_stride = Inputs) const;
+        QuantizedWorkspace create_workspace() const;
+
+        // Calibrate on at most calibration_instances instances from the training partition
+        void quantize(
+            const Network<Real, Inputs, Outputs>& network,
+            const TrainingSet<Real>& training_set,
+            std::size_t calibration_instances,
+            Granularity granularity
+        );
+
+        // Bytes taken by the weights and the scales
+        std::size_t get_size() const;
+
+        constexpr std::size_t get_inputs() const {
+            return Inputs;
+        }
+
+        constexpr std::size_t get_outputs() const {
+            return Outputs;
+        }
+
+        std::vector<QuantizedLayer> layers;  // Hidden layers, then the output layer
+    private:
+        static constexpr std::int8_t LIMIT = 127;
+
+        static float calculate_scale(float maximum);
+        static std::int8_t quantize_value(float x, float inverse_scale);
+        static QuantizedLayer quantize_layer(const Matrix<Real>& weights, float input_scale, Granularity granularity);
+        std::size_t max_layer_size() const;
+        void process_layer(const QuantizedLayer& layer, const float* inputs, float* outputs, std::int8_t* quantized_inputs) const;
+    };
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void QuantizedNetwork<Real, Inputs, Outputs>::run(const Real* inputs, Real* outputs, QuantizedWorkspace& workspace) const {
+        assert(!layers.empty());
+        assert(workspace.front.size() >= max_layer_size());
+
+        float* current_outputs = workspace.front.data();
+        float* next_outputs = workspace.back.data();
+
+        for (std::size_t j = 0; j < Inputs; j++) {
+            current_outputs[j] = static_cast<float>(inputs[j]);
+        }
+
+        for (std::size_t i = 0; i < layers.size(); i++) {
+            process_layer(layers[i], current_outputs, next_outputs, workspace.inputs.data());
+
+            if (i + 1 == layers.size()) {
+                kernels::sigmoid(next_outputs, layers[i].size());
+            } else {
+                kernels::tanh(next_outputs, layers[i].size());
+            }
+
+            std::swap(current_outputs, next_outputs);
+        }
+
+        for (std::size_t j = 0; j < Outputs; j++) {
+            outputs[j] = static_cast<Real>(current_outputs[j]);
+        }
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void QuantizedNetwork<Real, Inputs, Outputs>::run_batch(const Real* inputs, std::size_t batch, Real* outputs, std::size_t inputs_stride) const {
+        QuantizedWorkspace workspace = create_workspace();
+
+        for (std::size_t i = 0; i < batch; i++) {
+            run(inputs + i * inputs_stride, outputs + i * Outputs, workspace);
+        }
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    QuantizedWorkspace QuantizedNetwork<Real, Inputs, Outputs>::create_workspace() const {
+        QuantizedWorkspace workspace;
+        workspace.front.resize(max_layer_size());
+        workspace.back.resize(max_layer_size());
+        workspace.inputs.resize(max_layer_size());
+
+        return workspace;
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void QuantizedNetwork<Real, Inputs, Outputs>::quantize(
+        const Network<Real, Inputs, Outputs>& network,
+        const TrainingSet<Real>& training_set,
+        std::size_t calibration_instances,
+        Granularity granularity
+    ) {
+        const std::size_t layer_count = network.hidden_layers.size() + 1;
+        const std::size_t instance_count = std::min(calibration_instances, training_set.training_instance_count);
+
+        assert(training_set.features.get_columns() == Inputs);
+
+        // Largest absolute input of every layer
+        std::vector<float> maximums(layer_count, 0.0f);
+
+        Trace<Real, Outputs> trace = network.create_trace();
+        std::array<Real, Outputs> outputs {};
+
+        for (std::size_t i = 0; i < instance_count; i++) {
+            const std::span<const Real> inputs = training_set.row(i);
+            network.run(inputs.data(), outputs.data(), trace);
+
+            for (const Real input : inputs) {
+                maximums[0] = std::max(maximums[0], static_cast<float>(std::abs(input)));
+            }
+
+            for (std::size_t l = 0; l < network.hidden_layers.size(); l++) {
+                for (const Real output : trace.hidden_outputs[l]) {
+                    maximums[l + 1] = std::max(maximums[l + 1], static_cast<float>(std::abs(output)));
+                }
+            }
+        }
+
+        layers.clear();
+        layers.reserve(layer_count);
+
+        for (std::size_t l = 0; l < network.hidden_layers.size(); l++) {
+            layers.push_back(quantize_layer(network.hidden_layers[l].weights, calculate_scale(maximums[l]), granularity));
+        }
+
+        layers.push_back(quantize_layer(network.output_layer.weights, calculate_scale(maximums.back()), granularity));
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    std::size_t QuantizedNetwork<Real, Inputs, Outputs>::get_size() const {
+        std::size_t size = 0;
+
+        for (const QuantizedLayer& layer : layers) {
+            size += layer.weights.get_rows() * layer.weights.get_columns() * sizeof(std::int8_t);
+            size += layer.scales.size() * sizeof(float) + sizeof(layer.input_scale);
+        }
+
+        return size;
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    float QuantizedNetwork<Real, Inputs, Outputs>::calculate_scale(float maximum) {
+        // Without calibration data assume values in [-1, 1], like the outputs of tanh
+        if (maximum == 0.0f) {
+            maximum = 1.0f;
+        }
+
+        return maximum / static_cast<float>(LIMIT);
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    std::int8_t QuantizedNetwork<Real, Inputs, Outputs>::quantize_value(float x, float inverse_scale) {
+        const float rounded = std::round(x * inverse_scale);
+
+        return static_cast<std::int8_t>(std::clamp(rounded, -static_cast<float>(LIMIT), static_cast<float>(LIMIT)));
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    QuantizedLayer QuantizedNetwork<Real, Inputs, Outputs>::quantize_layer(const Matrix<Real>& weights, float input_scale, Granularity granularity) {
+        QuantizedLayer layer;
+        layer.weights = Matrix<std::int8_t>(weights.get_rows(), weights.get_columns());
+        layer.scales.resize(weights.get_rows());
+        layer.input_scale = input_scale;
+
+        float layer_maximum = 0.0f;
+
+        for (std::size_t i = 0; i < weights.get_rows(); i++) {
+            for (std::size_t j = 0; j < weights.get_columns(); j++) {
+                layer_maximum = std::max(layer_maximum, static_cast<float>(std::abs(weights(i, j))));
+            }
+        }
+
+        for (std::size_t i = 0; i < weights.get_rows(); i++) {
+            float maximum = layer_maximum;
+
+            if (granularity == Granularity::Row) {
+                maximum = 0.0f;
+
+                for (std::size_t j = 0; j < weights.get_columns(); j++) {
+                    maximum = std::max(maximum, static_cast<float>(std::abs(weights(i, j))));
+                }
+            }
+
+            layer.scales[i] = calculate_scale(maximum);
+
+            const float inverse_scale = 1.0f / layer.scales[i];
+
+            for (std::size_t j = 0; j < weights.get_columns(); j++) {
+                layer.weights(i, j) = quantize_value(static_cast<float>(weights(i, j)), inverse_scale);
+            }
+        }
+
+        return layer;
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    std::size_t QuantizedNetwork<Real, Inputs, Outputs>::max_layer_size() const {
+        std::size_t size = Inputs;
+
+        for (const QuantizedLayer& layer : layers) {
+            size = std::max(size, layer.size());
+        }
+
+        return size;
+    }
+
+    template<typename Real, std::size_t Inputs, std::size_t Outputs>
+    void QuantizedNetwork<Real, Inputs, Outputs>::process_layer(const QuantizedLayer& layer, const float* inputs, float* outputs, std::int8_t* quantized_inputs) const {
+        const std::size_t columns = layer.weights.get_columns();
+        const float inverse_scale = 1.0f / layer.input_scale;
+
+        for (std::size_t j = 0; j < columns; j++) {
+            quantized_inputs[j] = quantize_value(inputs[j], inverse_scale);
+        }
+
+        for (std::size_t i = 0; i < layer.size(); i++) {
+            const std::int32_t accumulator = kernels::dot(quantized_inputs, layer.weights.row(i), columns);
+
+            outputs[i] = static_cast<float>(accumulator) * layer.input_scale * layer.scales[i];
+        }
+    }
+}
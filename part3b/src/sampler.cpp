@@ -0,0 +1,27 @@
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <utility>
+
+#include "sampler.hpp"
+
+Sampler::Sampler(std::uint64_t seed)
+    : engine(seed) {}
+
+void Sampler::seed(std::uint64_t seed) {
+    engine.seed(seed);
+}
+
+void Sampler::reset(std::size_t count) {
+    order.resize(count);
+    std::iota(order.begin(), order.end(), 0);
+}
+
+void Sampler::shuffle() {
+    // The bias of the modulo is negligible for any count that fits in memory
+    for (std::size_t i {order.size()}; i > 1; i--) {
+        const std::size_t j {static_cast<std::size_t>(engine() % i)};
+
+        std::swap(order[i - 1], order[j]);
+    }
+}
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <random>
+
+/*
+    Order in which the instances of a training set are visited. Only the indices are shuffled,
+    with Fisher-Yates, so a new order every epoch is one pass over the indices and the instances
+    themselves never move.
+
+    The swaps are drawn straight from the 64-bit engine, so an order depends only on the seed and
+    is the same with every standard library.
+*/
+
+class Sampler {
+public:
+    Sampler() = default;
+    explicit Sampler(std::uint64_t seed);
+
+    void seed(std::uint64_t seed);
+
+    // Visit the instances [0, count) in order, until the next shuffle
+    void reset(std::size_t count);
+    void shuffle();
+
+    std::size_t operator[](std::size_t i) const {
+        return order[i];
+    }
+
+    std::size_t size() const {
+        return order.size();
+    }
+
+    const std::vector<std::size_t>& get_order() const {
+        return order;
+    }
+private:
+    std::vector<std::size_t> order;
+    std::mt19937_64 engine;
+};
@@ -0,0 +1,121 @@
+#include <cstddef>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cassert>
+
+#include "statistics.hpp"
+#include "thread_pool.hpp"
+
+// Blocks smaller than this are not worth a thread
+static constexpr std::size_t MINIMUM_BLOCK_ROWS = 4096;
+
+Statistics::Statistics(std::size_t columns)
+    : minimums(columns, std::numeric_limits<double>::infinity()),
+    maximums(columns, -std::numeric_limits<double>::infinity()),
+    means(columns, 0.0), squared_differences(columns, 0.0) {}
+
+template<typename Real>
+void Statistics::add(const Real* row) {
+    count++;
+
+    const double inverse_count {1.0 / static_cast<double>(count)};
+    const std::size_t columns {get_columns()};
+
+    for (std::size_t j {0}; j < columns; j++) {
+        const double x {static_cast<double>(row[j])};
+        const double delta {x - means[j]};
+
+        means[j] += delta * inverse_count;
+        squared_differences[j] += delta * (x - means[j]);
+        minimums[j] = std::min(minimums[j], x);
+        maximums[j] = std::max(maximums[j], x);
+    }
+}
+
+void Statistics::merge(const Statistics& other) {
+    assert(other.get_columns() == get_columns());
+
+    if (other.count == 0) {
+        return;
+    }
+
+    const double count_a {static_cast<double>(count)};
+    const double count_b {static_cast<double>(other.count)};
+    const double total {count_a + count_b};
+
+    for (std::size_t j {0}; j < get_columns(); j++) {
+        const double delta {other.means[j] - means[j]};
+
+        means[j] += delta * count_b / total;
+        squared_differences[j] += other.squared_differences[j] + delta * delta * count_a * count_b / total;
+        minimums[j] = std::min(minimums[j], other.minimums[j]);
+        maximums[j] = std::max(maximums[j], other.maximums[j]);
+    }
+
+    count += other.count;
+}
+
+double Statistics::get_variance(std::size_t column) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    return squared_differences[column] / static_cast<double>(count);
+}
+
+template<typename Real>
+Statistics compute_statistics(const Matrix<Real>& features, std::size_t rows, ThreadPool* pool) {
+    assert(rows <= features.get_rows());
+
+    const std::size_t threads {pool != nullptr ? pool->size() : 1};
+    const std::size_t block_count {std::clamp<std::size_t>(rows / MINIMUM_BLOCK_ROWS, 1, threads)};
+
+    std::vector<Statistics> blocks(block_count, Statistics(features.get_columns()));
+
+    const auto accumulate = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t b {begin}; b < end; b++) {
+            const std::size_t first {rows * b / block_count};
+            const std::size_t last {rows * (b + 1) / block_count};
+
+            for (std::size_t i {first}; i < last; i++) {
+                blocks[b].add(features.row(i));
+            }
+        }
+    };
+
+    if (pool != nullptr) {
+        pool->parallel_for(block_count, accumulate);
+    } else {
+        accumulate(0, block_count);
+    }
+
+    // Always merged in the same order, so the result doesn't depend on the scheduling
+    for (std::size_t b {1}; b < block_count; b++) {
+        blocks[0].merge(blocks[b]);
+    }
+
+    return blocks[0];
+}
+
+Normalization make_normalization(const Statistics& statistics) {
+    Normalization normalization;
+
+    assert(statistics.get_columns() == normalization.minimum.size());
+
+    for (std::size_t j {0}; j < normalization.minimum.size(); j++) {
+        const double minimum {statistics.get_count() > 0 ? statistics.get_minimum(j) : 0.0};
+        const double maximum {statistics.get_count() > 0 ? statistics.get_maximum(j) : 1.0};
+
+        normalization.minimum[j] = minimum;
+        normalization.maximum[j] = maximum > minimum ? maximum : minimum + 1.0;
+    }
+
+    return normalization;
+}
+
+template void Statistics::add(const float* row);
+template void Statistics::add(const double* row);
+
+template Statistics compute_statistics(const Matrix<float>& features, std::size_t rows, ThreadPool* pool);
+template Statistics compute_statistics(const Matrix<double>& features, std::size_t rows, ThreadPool* pool);
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <array>
+
+#include "matrix.hpp"
+
+class ThreadPool;
+
+/*
+    Minimum, maximum, mean and variance of every column of a dataset, in one pass over the rows.
+    The mean and the variance are accumulated with Welford's algorithm, which stays accurate for
+    any number of rows. The columns are kept apart in arrays, so adding a row is one loop over
+    the columns that the compiler vectorizes.
+
+    Blocks of rows are accumulated on their own, possibly in parallel, then merged together with
+    the pairwise formula of Chan et al.
+*/
+
+// Every feature is mapped linearly from [minimum, maximum] to [0, 1]; by default nothing changes
+struct Normalization {
+    std::array<double, 18> minimum {};
+    std::array<double, 18> maximum {
+        1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0,
+        1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0
+    };
+};
+
+class Statistics {
+public:
+    Statistics() = default;
+    explicit Statistics(std::size_t columns);
+
+    template<typename Real>
+    void add(const Real* row);
+
+    void merge(const Statistics& other);
+
+    std::size_t get_columns() const { return means.size(); }
+    std::size_t get_count() const { return count; }
+
+    double get_minimum(std::size_t column) const { return minimums[column]; }
+    double get_maximum(std::size_t column) const { return maximums[column]; }
+    double get_mean(std::size_t column) const { return means[column]; }
+
+    // Of the population; zero without rows
+    double get_variance(std::size_t column) const;
+private:
+    std::size_t count {0};
+    std::vector<double> minimums;
+    std::vector<double> maximums;
+    std::vector<double> means;
+    std::vector<double> squared_differences;  // Sums of the squared differences from the means
+};
+
+// Of the first rows of the features, split in one block for every thread of the pool, if not null
+template<typename Real>
+Statistics compute_statistics(const Matrix<Real>& features, std::size_t rows, ThreadPool* pool = nullptr);
+
+// Map every column from its minimum to its maximum; a constant column is mapped to zero
+Normalization make_normalization(const Statistics& statistics);
@@ -0,0 +1,370 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <fstream>
+#include <numeric>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <optional>
+#include <random>
+#include <algorithm>
+#include <utility>
+#include <span>
+
+#include "helpers.hpp"
+#include "csv.hpp"
+
+/*
+    Training set read from a CSV a chunk at a time, for datasets bigger than the memory. The file
+    is split in chunks of whole lines once, when opened. Every epoch visits the chunks in a new
+    random order and the rows of a chunk in a new random order too, so the instances are shuffled
+    without ever being all in memory.
+
+    A thread reads and parses the next chunk while the current one is trained on. There are three
+    chunks of rows at a time (consumed, ready and being read) and the text of one, so a chunk is a
+    quarter of the memory budget, as a parsed row takes about as much memory as its line.
+
+    The whole file is trained on, so the testing rows must be in another file. nn3b_stream shows
+    the steps: open(), compute_statistics(), make_normalization(), then Learn::stream and train().
+*/
+
+template<typename Real>
+class StreamingDataset {
+public:
+    struct {
+        std::size_t memory_budget {256 * 1024 * 1024};
+        std::uint64_t seed {0};
+        bool shuffle {true};
+        bool normalize {true};
+        Normalization normalization;  // Like make_normalization() of compute_statistics()
+    } options;
+
+    StreamingDataset() = default;
+
+    ~StreamingDataset() {
+        stop();
+    }
+
+    StreamingDataset(const StreamingDataset&) = delete;
+    StreamingDataset& operator=(const StreamingDataset&) = delete;
+
+    // Split the file in chunks; return false and fill the error, if it's not the dataset
+    bool open(const std::string& file_name, csv::Error& error);
+
+    // Start over from the first chunk of a new order; must be called before the first epoch too
+    void begin_epoch();
+
+    // The next instance of the epoch, valid until the next call; nothing at the end of the epoch
+    // or at an error in the file
+    std::optional<Sample<Real>> next();
+
+    const std::optional<csv::Error>& get_error() const {
+        return error;
+    }
+
+    std::size_t get_chunk_count() const {
+        return chunks.size();
+    }
+
+    // One pass over the whole file, a chunk at a time, for the normalization; stops an epoch in
+    // progress. Every row goes into the statistics, so the file must hold only training rows.
+    // Return false and fill the error, if the file can't be read or a line is invalid
+    bool compute_statistics(Statistics& statistics, csv::Error& error);
+private:
+    struct Range {
+        std::uint64_t begin {0};
+        std::uint64_t end {0};
+    };
+
+    // Parsed rows of a chunk; they are shuffled by their order, without moving the features
+    struct Rows {
+        std::vector<Real> features;  // Packed, csv::FEATURES for every label
+        std::vector<Real> labels;
+        std::vector<std::size_t> order;
+
+        std::size_t size() const {
+            return labels.size();
+        }
+
+        void clear() {
+            features.clear();
+            labels.clear();
+            order.clear();
+        }
+    };
+
+    static constexpr std::size_t MINIMUM_CHUNK_SIZE = 64 * 1024;
+    static constexpr std::size_t SEARCH_SIZE = 4096;
+
+    void stop();
+    void prefetch(std::vector<std::size_t> order, std::uint64_t seed);
+    bool read_chunk(std::ifstream& stream, const Range& range, std::string& text, Rows& rows, csv::Error& error) const;
+    static std::optional<std::uint64_t> find_line_end(std::ifstream& stream, std::uint64_t position, std::uint64_t size);
+
+    std::string file_name;
+    std::vector<Range> chunks;
+    std::mt19937_64 engine;
+
+    // Rows being consumed
+    Rows current;
+    std::size_t position {0};
+    std::size_t consumed_chunks {0};
+
+    // Rows handed over by the thread
+    Rows ready_rows;
+    bool ready {false};
+    std::optional<csv::Error> error;
+
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool cancelled {false};
+};
+
+template<typename Real>
+bool StreamingDataset<Real>::open(const std::string& file_name, csv::Error& error) {
+    stop();
+
+    chunks.clear();
+    engine.seed(options.seed);
+
+    std::ifstream stream {file_name, std::ios::binary | std::ios::ate};
+
+    if (!stream.is_open()) {
+        error = {0, 0, "Could not open " + file_name};
+        return false;
+    }
+
+    const std::uint64_t size {static_cast<std::uint64_t>(stream.tellg())};
+
+    std::string start(std::min<std::uint64_t>(size, MINIMUM_CHUNK_SIZE), '\0');
+    stream.seekg(0);
+    stream.read(start.data(), static_cast<std::streamsize>(start.size()));
+
+    const std::size_t header {csv::header_size(start)};
+
+    if (!stream.good() || header == 0) {
+        error = {1, 1, "Expected the header of the dataset"};
+        return false;
+    }
+
+    const std::uint64_t chunk_size {std::max(options.memory_budget / 4, MINIMUM_CHUNK_SIZE)};
+
+    for (std::uint64_t begin {header}; begin < size;) {
+        std::uint64_t end {size};
+
+        if (size - begin > chunk_size) {
+            const std::optional<std::uint64_t> line_end {find_line_end(stream, begin + chunk_size - 1, size)};
+
+            if (!line_end) {
+                error = {0, 0, "Could not read " + file_name};
+                return false;
+            }
+
+            end = *line_end;
+        }
+
+        chunks.push_back({begin, end});
+
+        begin = end;
+    }
+
+    this->file_name = file_name;
+
+    return true;
+}
+
+template<typename Real>
+void StreamingDataset<Real>::begin_epoch() {
+    stop();
+
+    current.clear();
+    position = 0;
+    consumed_chunks = 0;
+    ready = false;
+    error.reset();
+    cancelled = false;
+
+    std::vector<std::size_t> order(chunks.size());
+    std::iota(order.begin(), order.end(), 0);
+
+    if (options.shuffle) {
+        std::shuffle(order.begin(), order.end(), engine);
+    }
+
+    thread = std::thread(&StreamingDataset::prefetch, this, std::move(order), engine());
+}
+
+template<typename Real>
+std::optional<Sample<Real>> StreamingDataset<Real>::next() {
+    while (position == current.size()) {
+        if (consumed_chunks == chunks.size()) {
+            return std::nullopt;
+        }
+
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+            condition.wait(lock, [this]() { return ready || error; });
+
+            if (!ready) {
+                return std::nullopt;
+            }
+
+            // The rows consumed go back to the thread, which reuses their memory
+            std::swap(current, ready_rows);
+            ready = false;
+        }
+
+        condition.notify_one();
+
+        position = 0;
+        consumed_chunks++;
+    }
+
+    const std::size_t row {current.order[position++]};
+
+    return Sample<Real> {{current.features.data() + row * csv::FEATURES, csv::FEATURES}, current.labels[row]};
+}
+
+template<typename Real>
+bool StreamingDataset<Real>::compute_statistics(Statistics& statistics, csv::Error& error) {
+    stop();
+
+    std::ifstream stream {file_name, std::ios::binary};
+    std::string text;
+    Rows rows;
+
+    statistics = Statistics(csv::FEATURES);
+
+    for (const Range& range : chunks) {
+        if (!read_chunk(stream, range, text, rows, error)) {
+            return false;
+        }
+
+        for (std::size_t i {0}; i < rows.size(); i++) {
+            statistics.add(rows.features.data() + i * csv::FEATURES);
+        }
+    }
+
+    return true;
+}
+
+template<typename Real>
+void StreamingDataset<Real>::stop() {
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        cancelled = true;
+    }
+
+    condition.notify_one();
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+template<typename Real>
+void StreamingDataset<Real>::prefetch(std::vector<std::size_t> order, std::uint64_t seed) {
+    std::mt19937_64 row_engine {seed};
+    std::ifstream stream {file_name, std::ios::binary};
+    std::string text;
+    Rows rows;
+
+    for (const std::size_t chunk : order) {
+        csv::Error chunk_error;
+
+        if (!read_chunk(stream, chunks[chunk], text, rows, chunk_error)) {
+            std::lock_guard<std::mutex> lock {mutex};
+            error = std::move(chunk_error);
+            condition.notify_one();
+
+            return;
+        }
+
+        rows.order.resize(rows.size());
+        std::iota(rows.order.begin(), rows.order.end(), 0);
+
+        if (options.shuffle) {
+            std::shuffle(rows.order.begin(), rows.order.end(), row_engine);
+        }
+
+        if (options.normalize) {
+            normalize_rows(rows.features.data(), rows.size(), csv::FEATURES, csv::FEATURES, options.normalization);
+        }
+
+        std::unique_lock<std::mutex> lock {mutex};
+        condition.wait(lock, [this]() { return !ready || cancelled; });
+
+        if (cancelled) {
+            return;
+        }
+
+        std::swap(ready_rows, rows);
+        ready = true;
+
+        lock.unlock();
+        condition.notify_one();
+    }
+}
+
+template<typename Real>
+bool StreamingDataset<Real>::read_chunk(
+    std::ifstream& stream,
+    const Range& range,
+    std::string& text,
+    Rows& rows,
+    csv::Error& error
+) const {
+    text.resize(static_cast<std::size_t>(range.end - range.begin));
+
+    stream.seekg(static_cast<std::streamoff>(range.begin));
+    stream.read(text.data(), static_cast<std::streamsize>(text.size()));
+
+    if (!stream.good()) {
+        error = {0, 0, "Could not read " + file_name};
+        return false;
+    }
+
+    // Lines are known only from the start of the chunk, as the chunks are read in any order
+    if (!csv::parse_rows<Real>(text, rows.features, rows.labels, error)) {
+        error.message = "In the chunk at byte " + std::to_string(range.begin) + ", line " + std::to_string(error.line)
+            + ", column " + std::to_string(error.column) + ": " + error.message;
+        error.line = 0;
+        error.column = 0;
+
+        return false;
+    }
+
+    return true;
+}
+
+template<typename Real>
+std::optional<std::uint64_t> StreamingDataset<Real>::find_line_end(std::ifstream& stream, std::uint64_t position, std::uint64_t size) {
+    char buffer[SEARCH_SIZE];
+
+    while (position < size) {
+        const std::size_t count {static_cast<std::size_t>(std::min<std::uint64_t>(SEARCH_SIZE, size - position))};
+
+        stream.seekg(static_cast<std::streamoff>(position));
+        stream.read(buffer, static_cast<std::streamsize>(count));
+
+        if (!stream.good()) {
+            return std::nullopt;
+        }
+
+        const char* newline {std::find(buffer, buffer + count, '\n')};
+
+        if (newline != buffer + count) {
+            return position + static_cast<std::uint64_t>(newline - buffer) + 1;
+        }
+
+        position += count;
+    }
+
+    return size;
+}
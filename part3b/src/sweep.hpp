@@ -0,0 +1,178 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstddef>
+#include <algorithm>
+#include <optional>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cassert>
+
+#include "network.hpp"
+
+/*
+    What-if analysis: one or two inputs of a base input vector are varied over a grid while the
+    others stay the same, and every variant is run through the network. The variants are run in
+    batches on a background thread, so a grid of 256 x 256 is done in a few batched passes.
+
+    The network must not be changed while the sweep is running.
+*/
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+class Sweep {
+public:
+    // Steps values evenly spaced from one end to the other, both included
+    struct Axis {
+        std::size_t input {0};
+        Real from {0.0};
+        Real to {1.0};
+        std::size_t steps {2};
+
+        Real value(std::size_t i) const {
+            if (steps < 2) {
+                return from;
+            }
+
+            return from + (to - from) * static_cast<Real>(i) / static_cast<Real>(steps - 1);
+        }
+    };
+
+    Sweep() = default;
+
+    ~Sweep() {
+        cancel();
+    }
+
+    Sweep(const Sweep&) = delete;
+    Sweep& operator=(const Sweep&) = delete;
+
+    // A running sweep is cancelled first; with only x the results are a line, with y they are
+    // y.steps rows of x.steps points
+    void start(
+        const network::Network<Real, Inputs, Outputs>& network,
+        const std::array<Real, Inputs>& base,
+        const Axis& x,
+        std::optional<Axis> y = std::nullopt
+    );
+
+    void cancel();
+
+    bool is_running() const {
+        return running.load(std::memory_order_acquire);
+    }
+
+    // True, if the last sweep ran to the end; the results are valid only then
+    bool is_done() const {
+        return !is_running() && done;
+    }
+
+    // Outputs of every point, row by row
+    const std::vector<Real>& get_outputs() const {
+        return outputs;
+    }
+
+    const Axis& get_x() const {
+        return x;
+    }
+
+    const std::optional<Axis>& get_y() const {
+        return y;
+    }
+
+    // Time taken by the last sweep, in seconds
+    double get_duration() const {
+        return duration;
+    }
+private:
+    // Points run together; big enough for the batches to be efficient, small enough to cancel quickly
+    static constexpr std::size_t CHUNK = 4096;
+
+    void work(const network::Network<Real, Inputs, Outputs>& network, const std::array<Real, Inputs>& base);
+
+    Axis x;
+    std::optional<Axis> y;
+    std::vector<Real> outputs;
+    double duration {0.0};
+    bool done {false};
+
+    std::thread thread;
+    std::atomic<bool> running {false};
+    std::atomic<bool> cancelled {false};
+};
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Sweep<Real, Inputs, Outputs>::start(
+    const network::Network<Real, Inputs, Outputs>& network,
+    const std::array<Real, Inputs>& base,
+    const Axis& x,
+    std::optional<Axis> y
+) {
+    assert(x.input < Inputs);
+    assert(!y || y->input < Inputs);
+
+    cancel();
+
+    this->x = x;
+    this->y = y;
+    done = false;
+    cancelled.store(false, std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+
+    thread = std::thread([this, &network, base]() {
+        work(network, base);
+
+        running.store(false, std::memory_order_release);
+    });
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Sweep<Real, Inputs, Outputs>::cancel() {
+    cancelled.store(true, std::memory_order_relaxed);
+
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+template<typename Real, std::size_t Inputs, std::size_t Outputs>
+void Sweep<Real, Inputs, Outputs>::work(const network::Network<Real, Inputs, Outputs>& network, const std::array<Real, Inputs>& base) {
+    const auto start = std::chrono::steady_clock::now();
+
+    const std::size_t rows {y ? y->steps : 1};
+    const std::size_t points {rows * x.steps};
+
+    outputs.resize(points * Outputs);
+
+    network::Workspace<Real> workspace {network.create_workspace()};
+    std::vector<Real> inputs(std::min(CHUNK, points) * Inputs);
+
+    for (std::size_t begin {0}; begin < points; begin += CHUNK) {
+        if (cancelled.load(std::memory_order_relaxed)) {
+            return;
+        }
+
+        const std::size_t count {std::min(CHUNK, points - begin)};
+
+        for (std::size_t i {0}; i < count; i++) {
+            const std::size_t point {begin + i};
+            Real* row {inputs.data() + i * Inputs};
+
+            std::copy(base.begin(), base.end(), row);
+
+            row[x.input] = x.value(point % x.steps);
+
+            if (y) {
+                row[y->input] = y->value(point / x.steps);
+            }
+        }
+
+        network.run_batch(inputs.data(), count, outputs.data() + begin * Outputs, workspace);
+    }
+
+    const auto end = std::chrono::steady_clock::now();
+
+    duration = std::chrono::duration<double>(end - start).count();
+    done = true;
+}
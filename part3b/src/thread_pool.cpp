@@ -0,0 +1,108 @@
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <mutex>
+#include <algorithm>
+
+#include "thread_pool.hpp"
+
+ThreadPool::ThreadPool(std::size_t size) {
+    if (size == 0) {
+        size = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    workers.reserve(size - 1);
+
+    for (std::size_t i {0}; i < size - 1; i++) {
+        workers.emplace_back([this, i]() {
+            work(i + 1);
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        stopping = true;
+    }
+
+    start.notify_all();
+
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::run(std::size_t count, const void* object, void (*invoke)(const void*, std::size_t, std::size_t)) {
+    std::lock_guard<std::mutex> calls_lock {calls_mutex};
+
+    Task current;
+    current.object = object;
+    current.invoke = invoke;
+    current.count = count;
+    current.chunks = std::min(size(), count);
+
+    if (current.chunks <= 1) {
+        invoke(object, 0, count);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock {mutex};
+        task = current;
+        remaining = workers.size();
+        generation++;
+    }
+
+    start.notify_all();
+
+    run_chunk(current, 0);
+
+    std::unique_lock<std::mutex> lock {mutex};
+
+    finish.wait(lock, [this]() {
+        return remaining == 0;
+    });
+}
+
+void ThreadPool::work(std::size_t index) {
+    std::uint64_t seen_generation {0};
+
+    while (true) {
+        Task current;
+
+        {
+            std::unique_lock<std::mutex> lock {mutex};
+
+            start.wait(lock, [this, seen_generation]() {
+                return stopping || generation != seen_generation;
+            });
+
+            if (stopping) {
+                return;
+            }
+
+            seen_generation = generation;
+            current = task;
+        }
+
+        if (index < current.chunks) {
+            run_chunk(current, index);
+        }
+
+        {
+            std::lock_guard<std::mutex> lock {mutex};
+
+            if (--remaining == 0) {
+                finish.notify_one();
+            }
+        }
+    }
+}
+
+void ThreadPool::run_chunk(const Task& task, std::size_t chunk) {
+    const std::size_t begin {task.count * chunk / task.chunks};
+    const std::size_t end {task.count * (chunk + 1) / task.chunks};
+
+    task.invoke(task.object, begin, end);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+
+/*
+    Persistent worker threads for splitting a range of rows. The calling thread takes part too, so
+    a pool of size N has N - 1 workers. Calls to parallel_for() from different threads are run one
+    after the other.
+*/
+
+class ThreadPool {
+public:
+    // Zero means one thread for every hardware thread
+    explicit ThreadPool(std::size_t size = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Split [0, count) into contiguous ranges and call function(begin, end) for each, in parallel
+    template<typename Function>
+    void parallel_for(std::size_t count, const Function& function) {
+        run(count, std::addressof(function), [](const void* object, std::size_t begin, std::size_t end) {
+            (*static_cast<const Function*>(object))(begin, end);
+        });
+    }
+
+    std::size_t size() const {
+        return workers.size() + 1;
+    }
+private:
+    struct Task {
+        const void* object = nullptr;
+        void (*invoke)(const void*, std::size_t, std::size_t) = nullptr;
+        std::size_t count = 0;
+        std::size_t chunks = 0;
+    };
+
+    void run(std::size_t count, const void* object, void (*invoke)(const void*, std::size_t, std::size_t));
+    void work(std::size_t index);
+    static void run_chunk(const Task& task, std::size_t chunk);
+
+    std::vector<std::thread> workers;
+
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable finish;
+    Task task;
+    std::uint64_t generation = 0;
+    std::size_t remaining = 0;
+    bool stopping = false;
+
+    std::mutex calls_mutex;
+};
@@ -5,6 +5,11 @@
 #include <array>
 #include <utility>
 #include <cstdio>
+#include <optional>
+#include <vector>
+#include <span>
+#include <random>
+#include <cmath>
 
 #include <gui_base/gui_base.hpp>
 #include <ImGuiFileDialog.h>
@@ -12,13 +17,16 @@
 
 #include "network.hpp"
 #include "learn.hpp"
+#include "quantized_network.hpp"
 #include "ui.hpp"
 #include "helpers.hpp"
+#include "sweep.hpp"
 
 namespace ui {
     static constexpr auto RED = ImVec4(0.9f, 0.65f, 0.65f, 1.0f);
+    static constexpr std::size_t CALIBRATION_INSTANCES = 1000;
 
-    bool learning_setup(Learn<18, 1>& learn, network::Network<18, 1>& network) {
+    bool learning_setup(Learn<Precision, 18, 1>& learn, network::Network<Precision, 18, 1>& network) {
         static int hidden_layers = 1;
         static std::array<int, 32> hidden_layer_neurons = { 50, 50, 50 };
 
@@ -73,6 +81,10 @@ namespace ui {
                 if (ImGui::Button("Choose training set")) {
                     ui::open_file_browser();
                 }
+
+                if (!learn.training_set.error.empty()) {
+                    ImGui::TextColored(RED, "%s", learn.training_set.error.c_str());
+                }
             }
 
             ImGui::Spacing();
@@ -82,6 +94,37 @@ namespace ui {
             ImGui::InputDouble("Learning rate", &learn.options.learning_rate);
             ImGui::InputDouble("Epsilon", &learn.options.epsilon);
             ImGui::InputScalar("Max epochs", ImGuiDataType_U64, &learn.options.max_epochs);
+            ImGui::Checkbox("Shuffle every epoch", &learn.options.shuffle);
+            ImGui::InputScalar("Seed", ImGuiDataType_U64, &learn.options.seed);
+
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Spacing();
+
+            ImGui::InputScalar("Checkpoint every epochs", ImGuiDataType_U64, &learn.checkpoints.options.every_epochs);
+            ImGui::InputDouble("Checkpoint every seconds", &learn.checkpoints.options.every_seconds);
+            if (ImGui::IsItemHovered()) {
+                if (ImGui::BeginTooltip()) {
+                    ImGui::Text("Zero for never; checkpoints are written to %s", learn.checkpoints.options.file_name.c_str());
+                    ImGui::EndTooltip();
+                }
+            }
+
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Spacing();
+
+            if (network.parallelism.pool != nullptr) {
+                ImGui::Text("Threads: %lu", network.parallelism.pool->size());
+            }
+
+            ImGui::InputScalar("Parallel from neurons", ImGuiDataType_U64, &network.parallelism.threshold);
+            if (ImGui::IsItemHovered()) {
+                if (ImGui::BeginTooltip()) {
+                    ImGui::Text("Layers with at least this many neurons are split across all the threads");
+                    ImGui::EndTooltip();
+                }
+            }
         }
 
         ImGui::End();
@@ -89,7 +132,7 @@ namespace ui {
         return apply;
     }
 
-    Operation learning_process(const Learn<18, 1>& learn) {
+    Operation learning_process(const Learn<Precision, 18, 1>& learn) {
         Operation result = Operation::None;
 
         if (ImGui::Begin("Learning Process")) {
@@ -100,6 +143,7 @@ namespace ui {
             ImGui::Text("Learning rate: %f", learn.options.learning_rate);
             ImGui::Text("Epsilon: %f", learn.options.epsilon);
             ImGui::Text("Max epochs: %lu", learn.options.max_epochs);
+            ImGui::Text("Checkpoints: %lu written, %lu failed", learn.checkpoints.get_written(), learn.checkpoints.get_failed());
 
             ImGui::Spacing();
             ImGui::Separator();
@@ -131,6 +175,22 @@ namespace ui {
                 if (ImGui::Button("Execute")) {
                     result = Operation::Execute;
                 }
+
+                if (ImGui::Button("Save")) {
+                    result = Operation::Save;
+                }
+
+                ImGui::SameLine();
+
+                if (ImGui::Button("Load")) {
+                    result = Operation::Load;
+                }
+
+                ImGui::SameLine();
+
+                if (ImGui::Button("Resume")) {
+                    result = Operation::Resume;
+                }
             }
         }
 
@@ -139,7 +199,7 @@ namespace ui {
         return result;
     }
 
-    void learning_graph(const Learn<18, 1>& learn) {
+    void learning_graph(const Learn<Precision, 18, 1>& learn) {
         if (ImGui::Begin("Learning Graph")) {
             ImPlot::SetNextAxesToFit();
 
@@ -161,21 +221,24 @@ namespace ui {
         ImGui::End();
     }
 
-    void training_set(TrainingSet& training_set) {
+    void training_set(TrainingSet<Precision>& training_set) {
         static constexpr int MAX_GROUP = 9;
         static int group = 0;
 
-        const std::size_t group_size = training_set.data.size() / (MAX_GROUP + 1);
+        const std::size_t group_size = training_set.size() / (MAX_GROUP + 1);
 
         if (ImGui::Begin("Training Set")) {
-            ImGui::Text("%lu/%lu are for training", training_set.training_instance_count, training_set.data.size());
+            ImGui::Text("%lu/%lu are for training", training_set.training_instance_count, training_set.size());
             ImGui::Spacing();
 
-            if (ImGui::Button("Shuffle")) {
-                training_set.shuffle();
-            }
+            // A new split after normalizing would keep the normalization of the old training partition
+            if (!training_set.normalized) {
+                if (ImGui::Button("Shuffle")) {
+                    training_set.shuffle(std::random_device {}());
+                }
 
-            ImGui::SameLine();
+                ImGui::SameLine();
+            }
 
             if (ImGui::Button("Normalize")) {
                 training_set.normalize();
@@ -183,6 +246,41 @@ namespace ui {
 
             ImGui::Spacing();
 
+            // Of the training partition; the normalization maps every column from its minimum to its maximum
+            if (ImGui::CollapsingHeader("Statistics")) {
+                const Statistics& statistics {training_set.statistics};
+
+                if (ImGui::BeginTable("Statistics", 5, ImGuiTableFlags_Borders)) {
+                    ImGui::TableSetupColumn("Column");
+                    ImGui::TableSetupColumn("Minimum");
+                    ImGui::TableSetupColumn("Maximum");
+                    ImGui::TableSetupColumn("Mean");
+                    ImGui::TableSetupColumn("Standard deviation");
+                    ImGui::TableHeadersRow();
+
+                    for (std::size_t j {0}; j < statistics.get_columns(); j++) {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("X%lu", j + 1);
+
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%f", statistics.get_minimum(j));
+
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%f", statistics.get_maximum(j));
+
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%f", statistics.get_mean(j));
+
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%f", std::sqrt(statistics.get_variance(j)));
+                    }
+
+                    ImGui::EndTable();
+                }
+
+                ImGui::Spacing();
+            }
+
             if (ImGui::SmallButton("<")) {
                 group = std::max(group - 1, 0);
             }
@@ -219,10 +317,11 @@ namespace ui {
                 ImGui::TableHeadersRow();
 
                 const std::size_t begin {group * group_size};
-                const std::size_t end {group == MAX_GROUP ? training_set.data.size() : (group + 1) * group_size};
+                const std::size_t end {group == MAX_GROUP ? training_set.size() : (group + 1) * group_size};
 
                 for (std::size_t i {1}, j {begin}; j < end; j++) {
-                    const Instance& instance = training_set.data[j];
+                    const std::span<const Precision> features = training_set.row(j);
+                    const Precision label = training_set.labels[j];
 
                     ImGui::TableNextColumn();
                     ImGui::Text("%lu", i);
@@ -235,65 +334,16 @@ namespace ui {
 
                     if (training_set.normalized) {
                         ImGui::TableNextColumn();
-                        ImGui::Text("%f", instance.classification);
+                        ImGui::Text("%f", label);
                     } else {
                         ImGui::TableNextColumn();
-                        ImGui::Text("%s", instance.classification == 1.0 ? "alive" : "failed");
+                        ImGui::Text("%s", label == 1.0 ? "alive" : "failed");
                     }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.current_assets);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.cost_of_goods_sold);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.depreciation_and_amortization);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.financial_performance);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.inventory);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.net_income);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_receivables);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.market_value);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.net_sales);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_assets);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_long_term_debt);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.earnings_before_interest_and_taxes);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.gross_profit);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_current_liabilities);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.retained_earnings);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_revenue);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_liabilities);
-
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", instance.total_operating_expenses);
+                    for (const Precision feature : features) {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%f", feature);
+                    }
                 }
 
                 ImGui::EndTable();
@@ -326,7 +376,7 @@ namespace ui {
         }
     }
 
-    bool testing(const Learn<18, 1>& learn, const network::Network<18, 1>& network) {
+    bool testing(const Learn<Precision, 18, 1>& learn, const network::Network<Precision, 18, 1>& network) {
         bool back = false;
 
         if (ImGui::Begin("Testing")) {
@@ -338,6 +388,9 @@ namespace ui {
             ImGui::Spacing();
 
             static double test_result {0.0};
+            static double quantized_test_result {0.0};
+            static int granularity {static_cast<int>(network::Granularity::Row)};
+            static network::QuantizedNetwork<Precision, 18, 1> quantized_network;
 
             if (ImGui::Button("Test")) {
                 test_result = learn.test(network);
@@ -345,15 +398,34 @@ namespace ui {
 
             ImGui::SameLine();
 
+            if (ImGui::Button("Test int8")) {
+                quantized_network.quantize(
+                    network,
+                    learn.training_set,
+                    CALIBRATION_INSTANCES,
+                    static_cast<network::Granularity>(granularity)
+                );
+
+                quantized_test_result = learn.test(quantized_network);
+            }
+
+            ImGui::SameLine();
+
             if (ImGui::Button("Go back")) {
                 back = true;
             }
 
+            ImGui::RadioButton("Scale per layer", &granularity, static_cast<int>(network::Granularity::Layer));
+            ImGui::SameLine();
+            ImGui::RadioButton("Scale per row", &granularity, static_cast<int>(network::Granularity::Row));
+
             ImGui::Spacing();
             ImGui::Separator();
             ImGui::Spacing();
 
             ImGui::TextColored(RED, "Test result: %f %%", test_result);
+            ImGui::TextColored(RED, "Int8 test result: %f %% (%lu bytes)", quantized_test_result, quantized_network.get_size());
+            ImGui::Text("The table shows the last tested model");
 
             ImGui::Spacing();
 
@@ -382,7 +454,12 @@ namespace ui {
                 ImGui::TableSetupColumn("X18");
                 ImGui::TableHeadersRow();
 
-                for (std::size_t i {1}; const Test& test : learn.testing.tests) {
+                for (std::size_t i {1}; const Test<Precision>& test : learn.testing.tests) {
+                    // Tests refer to the rows of the set, which may have been reloaded since
+                    if (test.index >= learn.training_set.size()) {
+                        break;
+                    }
+
                     ImGui::TableNextColumn();
                     ImGui::Text("%lu", i);
 
@@ -399,76 +476,192 @@ namespace ui {
                     ImGui::Text("%f", test.output);
 
                     ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.classification);
+                    ImGui::Text("%f", learn.training_set.labels[test.index]);
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.current_assets);
+                    for (const Precision feature : learn.training_set.row(test.index)) {
+                        ImGui::TableNextColumn();
+                        ImGui::Text("%f", feature);
+                    }
+                }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.cost_of_goods_sold);
+                ImGui::EndTable();
+            }
+        }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.depreciation_and_amortization);
+        ImGui::End();
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.financial_performance);
+        return back;
+    }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.inventory);
+    static constexpr const char* ATTRIBUTE_NAMES[] = {
+        "Current assets",
+        "Cost of goods sold",
+        "Depreciation and amortization",
+        "Financial performance",
+        "Inventory",
+        "Net income",
+        "Total receivables",
+        "Market value",
+        "Net sales",
+        "Total assets",
+        "Total long-term debt",
+        "EBIT",
+        "Gross profit",
+        "Total current liabilities",
+        "Retained earnings",
+        "Total revenue",
+        "Total liabilities",
+        "Total operating expenses"
+    };
+
+    static std::array<Precision, 18> normalized_inputs(const std::array<double, 18>& user_inputs, const Normalization& normalization) {
+        std::array<Precision, 18> inputs {};
+
+        for (std::size_t i {0}; i < 18; i++) {
+            inputs[i] = static_cast<Precision>(user_inputs[i]);
+        }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.net_income);
+        normalize_features(std::span<Precision>(inputs), normalization);
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_receivables);
+        return inputs;
+    }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.market_value);
+    // Every attribute is normalized on its own, so one input can be swept while the others stay
+    static Precision normalized_input(std::array<double, 18> user_inputs, const Normalization& normalization, std::size_t attribute, double value) {
+        user_inputs[attribute] = value;
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.net_sales);
+        return normalized_inputs(user_inputs, normalization)[attribute];
+    }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_assets);
+    static void sweep_controls(
+        const network::Network<Precision, 18, 1>& network,
+        const Normalization& normalization,
+        Sweep<Precision, 18, 1>& sweep,
+        const std::array<double, 18>& user_inputs
+    ) {
+        static int x_attribute = 0;
+        static int y_attribute = 1;
+        static std::array<double, 2> x_range = { 0.0, 100'000.0 };
+        static std::array<double, 2> y_range = { 0.0, 100'000.0 };
+        static int x_steps = 256;
+        static int y_steps = 256;
+        static bool two_attributes = false;
+
+        // Ranges of the last sweep, in the units of the attributes
+        static std::array<double, 4> swept {};
+
+        ImGui::Text("Sweep");
+        ImGui::Spacing();
+
+        ImGui::Combo("X attribute", &x_attribute, ATTRIBUTE_NAMES, 18);
+        ImGui::InputDouble("X from", x_range.data() + 0);
+        ImGui::InputDouble("X to", x_range.data() + 1);
+
+        if (ImGui::InputInt("X steps", &x_steps)) {
+            x_steps = std::clamp(x_steps, 2, 1024);
+        }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_long_term_debt);
+        ImGui::Checkbox("Two attributes", &two_attributes);
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.earnings_before_interest_and_taxes);
+        if (two_attributes) {
+            ImGui::Combo("Y attribute", &y_attribute, ATTRIBUTE_NAMES, 18);
+            ImGui::InputDouble("Y from", y_range.data() + 0);
+            ImGui::InputDouble("Y to", y_range.data() + 1);
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.gross_profit);
+            if (ImGui::InputInt("Y steps", &y_steps)) {
+                y_steps = std::clamp(y_steps, 2, 1024);
+            }
+        }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_current_liabilities);
+        if (ImGui::Button("Sweep")) {
+            Sweep<Precision, 18, 1>::Axis x;
+            x.input = static_cast<std::size_t>(x_attribute);
+            x.from = normalized_input(user_inputs, normalization, x.input, x_range[0]);
+            x.to = normalized_input(user_inputs, normalization, x.input, x_range[1]);
+            x.steps = static_cast<std::size_t>(x_steps);
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.retained_earnings);
+            std::optional<Sweep<Precision, 18, 1>::Axis> y;
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_revenue);
+            // The first row of a heatmap is drawn at the top, so the y axis goes downwards
+            if (two_attributes) {
+                y.emplace();
+                y->input = static_cast<std::size_t>(y_attribute);
+                y->from = normalized_input(user_inputs, normalization, y->input, y_range[1]);
+                y->to = normalized_input(user_inputs, normalization, y->input, y_range[0]);
+                y->steps = static_cast<std::size_t>(y_steps);
+            }
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_liabilities);
+            swept = { x_range[0], x_range[1], y_range[0], y_range[1] };
 
-                    ImGui::TableNextColumn();
-                    ImGui::Text("%f", test.instance.total_operating_expenses);
-                }
+            sweep.start(network, normalized_inputs(user_inputs, normalization), x, y);
+        }
 
-                ImGui::EndTable();
-            }
+        ImGui::SameLine();
+
+        if (sweep.is_running()) {
+            ImGui::Text("Sweeping...");
+            return;
         }
 
-        ImGui::End();
+        if (!sweep.is_done()) {
+            return;
+        }
 
-        return back;
+        const auto& x = sweep.get_x();
+        const auto& y = sweep.get_y();
+        const std::vector<Precision>& outputs = sweep.get_outputs();
+
+        ImGui::Text("%lu points in %.2f ms", outputs.size(), sweep.get_duration() * 1000.0);
+
+        if (y) {
+            if (ImPlot::BeginPlot("##Sweep", ImVec2(-80.0f, 400.0f))) {
+                ImPlot::SetupAxes(ATTRIBUTE_NAMES[x.input], ATTRIBUTE_NAMES[y->input]);
+
+                ImPlot::PlotHeatmap(
+                    "Output",
+                    outputs.data(),
+                    static_cast<int>(y->steps),
+                    static_cast<int>(x.steps),
+                    0.0,
+                    1.0,
+                    nullptr,
+                    ImPlotPoint(swept[0], swept[2]),
+                    ImPlotPoint(swept[1], swept[3])
+                );
+
+                ImPlot::EndPlot();
+            }
+
+            ImGui::SameLine();
+            ImPlot::ColormapScale("##Scale", 0.0, 1.0, ImVec2(60.0f, 400.0f));
+        } else {
+            static std::vector<double> values;
+            static std::vector<double> results;
+
+            values.resize(x.steps);
+            results.resize(x.steps);
+
+            for (std::size_t i {0}; i < x.steps; i++) {
+                values[i] = swept[0] + (swept[1] - swept[0]) * static_cast<double>(i) / static_cast<double>(x.steps - 1);
+                results[i] = outputs[i];
+            }
+
+            if (ImPlot::BeginPlot("##Sweep", ImVec2(-1.0f, 400.0f))) {
+                ImPlot::SetupAxes(ATTRIBUTE_NAMES[x.input], "Output");
+                ImPlot::SetupAxisLimits(ImAxis_X1, swept[0], swept[1], ImPlotCond_Always);
+                ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, 1.0);
+
+                ImPlot::PlotLine("Output", values.data(), results.data(), static_cast<int>(x.steps));
+
+                ImPlot::EndPlot();
+            }
+        }
     }
 
-    bool executing(const network::Network<18, 1>& network) {
+    bool executing(const network::Network<Precision, 18, 1>& network, const Normalization& normalization, Sweep<Precision, 18, 1>& sweep) {
         static std::array<double, 18> user_inputs {};
-        static std::array<double, 18> inputs {};
-        static std::array<double, 1> outputs {};
+        static std::array<Precision, 18> inputs {};
+        static std::array<Precision, 1> outputs {};
 
         bool back = false;
 
@@ -629,48 +822,10 @@ namespace ui {
             ImGui::Spacing();
 
             if (ImGui::Button("Execute")) {
-                Instance instance;
-                instance.current_assets = user_inputs[0];
-                instance.cost_of_goods_sold = user_inputs[1];
-                instance.depreciation_and_amortization = user_inputs[2];
-                instance.financial_performance = user_inputs[3];
-                instance.inventory = user_inputs[4];
-                instance.net_income = user_inputs[5];
-                instance.total_receivables = user_inputs[6];
-                instance.market_value = user_inputs[7];
-                instance.net_sales = user_inputs[8];
-                instance.total_assets = user_inputs[9];
-                instance.total_long_term_debt = user_inputs[10];
-                instance.earnings_before_interest_and_taxes = user_inputs[11];
-                instance.gross_profit = user_inputs[12];
-                instance.total_current_liabilities = user_inputs[13];
-                instance.retained_earnings = user_inputs[14];
-                instance.total_revenue = user_inputs[15];
-                instance.total_liabilities = user_inputs[16];
-                instance.total_operating_expenses = user_inputs[17];
-
-                normalize_instance(instance);
-
-                inputs[0] = instance.current_assets;
-                inputs[1] = instance.cost_of_goods_sold;
-                inputs[2] = instance.depreciation_and_amortization;
-                inputs[3] = instance.financial_performance;
-                inputs[4] = instance.inventory;
-                inputs[5] = instance.net_income;
-                inputs[6] = instance.total_receivables;
-                inputs[7] = instance.market_value;
-                inputs[8] = instance.net_sales;
-                inputs[9] = instance.total_assets;
-                inputs[10] = instance.total_long_term_debt;
-                inputs[11] = instance.earnings_before_interest_and_taxes;
-                inputs[12] = instance.gross_profit;
-                inputs[13] = instance.total_current_liabilities;
-                inputs[14] = instance.retained_earnings;
-                inputs[15] = instance.total_revenue;
-                inputs[16] = instance.total_liabilities;
-                inputs[17] = instance.total_operating_expenses;
-
-                network.run(inputs.data(), outputs.data());
+                inputs = normalized_inputs(user_inputs, normalization);
+
+                network::Workspace<Precision> workspace {network.create_workspace()};
+                network.run(inputs.data(), outputs.data(), workspace);
             }
 
             ImGui::SameLine();
@@ -678,6 +833,12 @@ namespace ui {
             if (ImGui::Button("Go back")) {
                 back = true;
             }
+
+            ImGui::Spacing();
+            ImGui::Separator();
+            ImGui::Spacing();
+
+            sweep_controls(network, normalization, sweep, user_inputs);
         }
 
         ImGui::End();
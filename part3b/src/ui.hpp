@@ -7,6 +7,8 @@
 
 #include "network.hpp"
 #include "learn.hpp"
+#include "precision.hpp"
+#include "sweep.hpp"
 
 namespace ui {
     enum class Operation {
@@ -16,14 +18,17 @@ namespace ui {
         Reinitialize,
         Test,
         Execute,
+        Save,
+        Load,
+        Resume,
     };
 
-    bool learning_setup(Learn<18, 1>& learn, network::Network<18, 1>& network);
-    Operation learning_process(const Learn<18, 1>& learn);
-    void learning_graph(const Learn<18, 1>& learn);
-    void training_set(TrainingSet& training_set);
+    bool learning_setup(Learn<Precision, 18, 1>& learn, network::Network<Precision, 18, 1>& network);
+    Operation learning_process(const Learn<Precision, 18, 1>& learn);
+    void learning_graph(const Learn<Precision, 18, 1>& learn);
+    void training_set(TrainingSet<Precision>& training_set);
     void open_file_browser();
     void file_browser(const std::function<void(const std::string&)>& callback);
-    bool testing(const Learn<18, 1>& learn, const network::Network<18, 1>& network);
-    bool executing(const network::Network<18, 1>& network);
+    bool testing(const Learn<Precision, 18, 1>& learn, const network::Network<Precision, 18, 1>& network);
+    bool executing(const network::Network<Precision, 18, 1>& network, const Normalization& normalization, Sweep<Precision, 18, 1>& sweep);
 }
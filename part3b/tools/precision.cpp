@@ -0,0 +1,181 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include "network.hpp"
+#include "learn.hpp"
+#include "quantized_network.hpp"
+
+/*
+    Train the same network on the bankruptcy dataset once in double and once in float, starting
+    from the same seed, and compare their outputs row by row on the testing partition. Reports the
+    largest absolute difference between the outputs and how often both predict the same label.
+    Fails when the outputs differ by more than the tolerance, or when the double network gives
+    nearly the same output for every row, as then the comparison says nothing. Both networks are
+    also quantized to int8, with one scale for every layer and with one for every row, and the
+    quantized outputs are compared the same way with those of the network they come from.
+
+    nn3b_precision [dataset] [epochs]
+*/
+
+static constexpr unsigned int SEED = 42;
+static constexpr double LEARNING_RATE = 0.001;  // Higher rates saturate the tanh layers into a constant output
+static constexpr double TOLERANCE = 0.01;
+static constexpr double MINIMUM_SPREAD = 0.1;
+static constexpr std::size_t CALIBRATION_INSTANCES = 1000;
+
+struct Result {
+    std::vector<double> outputs;  // Of the testing partition
+    std::vector<double> layer_quantized_outputs;
+    std::vector<double> row_quantized_outputs;
+    double accuracy {0.0};
+    std::size_t size {0};
+    std::size_t quantized_size {0};
+};
+
+struct Comparison {
+    double max_difference {0.0};
+    double mean_difference {0.0};
+    double agreement {0.0};  // Percentage of rows with the same predicted label
+};
+
+template<typename Real>
+static std::size_t network_size(const network::Network<Real, 18, 1>& network) {
+    std::size_t size {network.output_layer.weights.get_rows() * network.output_layer.weights.get_columns()};
+
+    for (const auto& layer : network.hidden_layers) {
+        size += layer.weights.get_rows() * layer.weights.get_columns();
+    }
+
+    return size * sizeof(Real);
+}
+
+template<typename Real>
+static std::vector<double> get_outputs(const std::vector<Test<Real>>& tests) {
+    std::vector<double> outputs;
+    outputs.reserve(tests.size());
+
+    for (const Test<Real>& test : tests) {
+        outputs.push_back(static_cast<double>(test.output));
+    }
+
+    return outputs;
+}
+
+template<typename Real>
+static std::optional<Result> train_and_test(const char* file_name, unsigned long epochs) {
+    std::srand(SEED);
+
+    Learn<Real, 18, 1> learn;
+    network::Network<Real, 18, 1> network;
+
+    if (!learn.training_set.load(file_name, 30.0f)) {
+        std::fprintf(stderr, "%s\n", learn.training_set.error.c_str());
+        return std::nullopt;
+    }
+
+    learn.training_set.normalize();
+
+    network::HiddenLayers hidden_layers;
+    hidden_layers.layers = { 50, 50, 50 };
+    network.setup(std::move(hidden_layers));
+
+    learn.options.learning_rate = LEARNING_RATE;
+    learn.options.max_epochs = epochs;
+    learn.options.seed = SEED;
+    learn.train(network);
+
+    Result result;
+    result.accuracy = learn.test(network);
+    result.outputs = get_outputs(learn.testing.tests);
+    result.size = network_size(network);
+
+    network::QuantizedNetwork<Real, 18, 1> quantized_network;
+
+    quantized_network.quantize(network, learn.training_set, CALIBRATION_INSTANCES, network::Granularity::Layer);
+    learn.test(quantized_network);
+    result.layer_quantized_outputs = get_outputs(learn.testing.tests);
+
+    quantized_network.quantize(network, learn.training_set, CALIBRATION_INSTANCES, network::Granularity::Row);
+    learn.test(quantized_network);
+    result.row_quantized_outputs = get_outputs(learn.testing.tests);
+    result.quantized_size = quantized_network.get_size();
+
+    return std::make_optional(result);
+}
+
+static Comparison compare(const std::vector<double>& outputs, const std::vector<double>& other_outputs) {
+    Comparison comparison;
+    std::size_t agreeing {0};
+
+    for (std::size_t i {0}; i < outputs.size(); i++) {
+        const double difference {std::abs(outputs[i] - other_outputs[i])};
+
+        comparison.max_difference = std::max(comparison.max_difference, difference);
+        comparison.mean_difference += difference;
+
+        if ((outputs[i] >= 0.5) == (other_outputs[i] >= 0.5)) {
+            agreeing++;
+        }
+    }
+
+    comparison.mean_difference /= static_cast<double>(outputs.size());
+    comparison.agreement = static_cast<double>(agreeing) / static_cast<double>(outputs.size()) * 100.0;
+
+    return comparison;
+}
+
+static double spread(const std::vector<double>& outputs) {
+    const auto [minimum, maximum] = std::minmax_element(outputs.begin(), outputs.end());
+
+    return *maximum - *minimum;
+}
+
+static void print(const char* name, const Comparison& comparison) {
+    std::printf(
+        "  %-16s max difference %f, mean difference %f, same label %8.4f %%\n",
+        name, comparison.max_difference, comparison.mean_difference, comparison.agreement
+    );
+}
+
+static void print(const char* name, const Result& result) {
+    std::printf("%-8s %10.4f %% %10zu bytes\n", name, result.accuracy, result.size);
+    print("int8 per layer", compare(result.outputs, result.layer_quantized_outputs));
+    print("int8 per row", compare(result.outputs, result.row_quantized_outputs));
+    std::printf("  %-16s %zu bytes\n", "int8 size", result.quantized_size);
+}
+
+int main(int argc, char** argv) {
+    const char* file_name = argc > 1 ? argv[1] : "data/american_bankruptcy_filtered.csv";
+    const unsigned long epochs = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 20;
+
+    const auto result_double = train_and_test<double>(file_name, epochs);
+    const auto result_float = train_and_test<float>(file_name, epochs);
+
+    if (!result_double || !result_float) {
+        std::fprintf(stderr, "Could not load %s\n", file_name);
+        return 1;
+    }
+
+    print("double", *result_double);
+    print("float", *result_float);
+
+    const double output_spread = spread(result_double->outputs);
+    const Comparison comparison = compare(result_double->outputs, result_float->outputs);
+
+    std::printf("output spread: %f (minimum %f)\n", output_spread, MINIMUM_SPREAD);
+    std::printf("max difference: %f (tolerance %f)\n", comparison.max_difference, TOLERANCE);
+    std::printf("same label: %.4f %% of %zu rows\n", comparison.agreement, result_double->outputs.size());
+
+    if (output_spread < MINIMUM_SPREAD) {
+        std::fprintf(stderr, "The network gives almost the same output for every row\n");
+        return 1;
+    }
+
+    return comparison.max_difference <= TOLERANCE ? 0 : 1;
+}
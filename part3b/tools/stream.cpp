@@ -0,0 +1,190 @@
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "network.hpp"
+#include "learn.hpp"
+#include "streaming.hpp"
+#include "statistics.hpp"
+#include "precision.hpp"
+
+/*
+    Train the bankruptcy network on a CSV streamed from disk a chunk at a time, so the file can be
+    bigger than the memory. The whole file is the training partition: the normalization is made
+    from the statistics of all of its rows, so testing rows must be kept in another file.
+
+    Before training, one epoch is streamed without training to check that it visits every row of
+    the file exactly once: the count, the minimums, the maximums and the means of the columns must
+    be the ones of the statistics pass. If a testing CSV is given, the trained network is scored on
+    all of its rows, normalized like the training rows; an empty name skips it.
+
+    nn3b_stream <training dataset> [testing dataset] [epochs] [memory budget in MiB]
+*/
+
+static constexpr unsigned int SEED = 42;
+static constexpr double LEARNING_RATE = 0.001;
+
+// Relative to the largest magnitude of the column, as the means are summed in another order
+static constexpr double MEAN_TOLERANCE = 1e-9;
+
+static void print_error(const csv::Error& error) {
+    std::fprintf(stderr, "%s\n", error.to_string().c_str());
+}
+
+// Without normalizing, so that the rows can be compared with the statistics of the file
+static bool check_epoch(StreamingDataset<Precision>& stream, const Statistics& statistics) {
+    const bool normalize {stream.options.normalize};
+    stream.options.normalize = false;
+
+    Statistics visited {csv::FEATURES};
+
+    stream.begin_epoch();
+
+    while (const std::optional<Sample<Precision>> sample = stream.next()) {
+        visited.add(sample->features.data());
+    }
+
+    stream.options.normalize = normalize;
+
+    if (stream.get_error()) {
+        print_error(*stream.get_error());
+        return false;
+    }
+
+    if (visited.get_count() != statistics.get_count()) {
+        std::fprintf(stderr, "The epoch visited %zu rows of %zu\n", visited.get_count(), statistics.get_count());
+        return false;
+    }
+
+    for (std::size_t j {0}; j < csv::FEATURES; j++) {
+        const double magnitude {std::max({std::abs(statistics.get_minimum(j)), std::abs(statistics.get_maximum(j)), 1.0})};
+
+        const bool same {
+            visited.get_minimum(j) == statistics.get_minimum(j)
+            && visited.get_maximum(j) == statistics.get_maximum(j)
+            && std::abs(visited.get_mean(j) - statistics.get_mean(j)) <= MEAN_TOLERANCE * magnitude
+        };
+
+        if (!same) {
+            std::fprintf(stderr, "The epoch visited other rows than the file has, in column X%zu\n", j + 1);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Percentage of the rows of the file predicted right
+static std::optional<double> score(const network::Network<Precision, 18, 1>& network, const char* file_name, const Normalization& normalization) {
+    TrainingSet<Precision> testing_set;
+
+    if (!testing_set.load(file_name, 30.0f)) {
+        std::fprintf(stderr, "%s\n", testing_set.error.c_str());
+        return std::nullopt;
+    }
+
+    auto& features {testing_set.features};
+
+    normalize_rows(features.get_data(), testing_set.size(), features.get_columns(), features.get_stride(), normalization);
+
+    std::vector<Precision> outputs(testing_set.size());
+    network.run_batch(features.get_data(), testing_set.size(), outputs.data(), features.get_stride());
+
+    std::size_t passed {0};
+
+    for (std::size_t i {0}; i < testing_set.size(); i++) {
+        if (network::functions::binary(outputs[i]) == testing_set.labels[i]) {
+            passed++;
+        }
+    }
+
+    return std::make_optional(static_cast<double>(passed) / static_cast<double>(testing_set.size()) * 100.0);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::fprintf(stderr, "Usage: %s <training dataset> [testing dataset] [epochs] [memory budget in MiB]\n", argv[0]);
+        return 1;
+    }
+
+    const char* training_file_name = argv[1];
+    const char* testing_file_name = argc > 2 && argv[2][0] != '\0' ? argv[2] : nullptr;
+    const unsigned long epochs = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 5;
+    const std::size_t memory_budget = argc > 4 ? std::strtoull(argv[4], nullptr, 10) * 1024 * 1024 : 256 * 1024 * 1024;
+
+    std::srand(SEED);
+
+    StreamingDataset<Precision> stream;
+    stream.options.memory_budget = memory_budget;
+    stream.options.seed = SEED;
+
+    csv::Error error;
+
+    if (!stream.open(training_file_name, error)) {
+        print_error(error);
+        return 1;
+    }
+
+    Statistics statistics;
+
+    if (!stream.compute_statistics(statistics, error)) {
+        print_error(error);
+        return 1;
+    }
+
+    if (statistics.get_count() == 0) {
+        std::fprintf(stderr, "%s has no rows\n", training_file_name);
+        return 1;
+    }
+
+    stream.options.normalization = make_normalization(statistics);
+
+    std::printf("%zu rows in %zu chunks\n", statistics.get_count(), stream.get_chunk_count());
+
+    if (!check_epoch(stream, statistics)) {
+        return 1;
+    }
+
+    std::printf("one epoch visits every row once\n");
+
+    Learn<Precision, 18, 1> learn;
+    network::Network<Precision, 18, 1> network;
+
+    network::HiddenLayers hidden_layers;
+    hidden_layers.layers = { 50, 50, 50 };
+    network.setup(std::move(hidden_layers));
+
+    learn.stream = &stream;
+    learn.options.learning_rate = LEARNING_RATE;
+    learn.options.max_epochs = epochs;
+    learn.train(network);
+
+    if (stream.get_error()) {
+        print_error(*stream.get_error());
+        return 1;
+    }
+
+    const std::vector<double>& errors {learn.learning.error_graph.errors};
+
+    for (std::size_t i {0}; i < errors.size(); i++) {
+        std::printf("epoch %zu error %f\n", i + 1, errors[i]);
+    }
+
+    if (testing_file_name != nullptr) {
+        const std::optional<double> accuracy {score(network, testing_file_name, learn.get_normalization())};
+
+        if (!accuracy) {
+            return 1;
+        }
+
+        std::printf("accuracy on %s: %.4f %%\n", testing_file_name, *accuracy);
+    }
+
+    return 0;
+}